@@ -29,13 +29,27 @@
 #ifndef HIWIN_ROBOT_CLIENT_LIBRARY_COMMANDER_HPP_
 #define HIWIN_ROBOT_CLIENT_LIBRARY_COMMANDER_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <string>
 #include <vector>
 
+#include "hiwin_robot_client_library/protocol.hpp"
+#include "hiwin_robot_client_library/socket/reactor.hpp"
 #include "hiwin_robot_client_library/socket/tcp_client.hpp"
 
 namespace hrsdk
 {
 
+/// Result returned by Commander methods when no valid response could be exchanged with the controller
+static const int COMMUNICATION_ERROR = -1;
+
 enum class ControlMode : uint16_t
 {
   Manual = 0,
@@ -61,19 +75,183 @@ enum class LogLevels
   Save,
 };
 
+/// Round-trip times of answered commands, see Commander::getLatencyStats
+struct LatencyStats
+{
+  uint64_t count;
+  int64_t min_ns;
+  int64_t max_ns;
+  int64_t mean_ns;
+  int64_t last_ns;
+};
+
+/// Joint state gathered by Commander::getActualState in one pipelined exchange
+struct ActualState
+{
+  enum Field
+  {
+    Position = 0,
+    Velocity,
+    Effort,
+    Motion,
+    Error,
+    ExtPosition,
+    ExtVelocity,
+    FIELD_COUNT
+  };
+
+  double positions[6];
+  double velocities[6];
+  double efforts[6];
+  double ext_positions[3];
+  double ext_velocities[3];
+  MotionStatus motion_status;
+  ErrorList errors;
+
+  /// Result code of each field's command, indexed by Field. Fields not requested report COMMUNICATION_ERROR.
+  int results[FIELD_COUNT];
+};
+
 class Commander : public socket::TCPClient
 {
 private:
   std::string robot_ip_;
   int port_;
 
+  typedef std::function<void(int result, const Responseformat& response)> ResponseHandler;
+
+  struct PendingRequest
+  {
+    uint16_t cmd_id;
+    ResponseHandler handler;
+    std::chrono::steady_clock::time_point sent;
+  };
+
+  // Requests written to the socket whose responses are still outstanding, oldest first. The
+  // receiver thread completes them in FIFO order as responses arrive.
+  mutable std::mutex pending_mutex_;
+  std::condition_variable window_cv_;
+  std::deque<PendingRequest> pending_;
+  size_t pipeline_depth_;
+  bool receiving_;
+  LatencyStats latency_;
+  int64_t latency_total_ns_;
+
+  // Serialises frames onto the socket; held only while writing, never while waiting for a response
+  // or for room in the pipeline
+  std::mutex write_mutex_;
+
+  // Priority submissions waiting for the socket. Other writers wait on window_cv_ while it is
+  // non-zero, and whoever brings it back to zero notifies them.
+  std::atomic<int> priority_waiting_;
+  std::thread receiver_thread_;
+  socket::Reactor* reactor_;
+
+  /*!
+   * \brief Writes \p count frames, queueing \p handlers to be called with their responses.
+   *
+   * Blocks while the pipeline is full. Handlers of frames that could not be sent are called
+   * straight away with COMMUNICATION_ERROR.
+   *
+   * Frames with \p priority set skip the pipeline limit and are written ahead of every other
+   * frame not yet on the socket, so they wait at most for one write already in progress. Their
+   * responses still come back in the order the controller received the frames.
+   *
+   * \return Number of frames sent
+   */
+  size_t submit(const Commandformat* w, const ResponseHandler* handlers, size_t count, bool priority = false);
+
+  /*!
+   * \brief Writes all \p count frames like submit(), or none of them if any would have to wait.
+   *
+   * \return false, without calling the handlers, if the pipeline lacks room for every frame, a
+   *         priority frame is waiting or another thread is writing
+   */
+  bool trySubmit(const Commandformat* w, const ResponseHandler* handlers, size_t count);
+
+  /// Writes frames already queued in pending_, failing those the socket did not take; \p sent receives how many it did
+  bool writeQueued(const Commandformat* w, const ResponseHandler* handlers, size_t count, size_t& sent);
+  void receiveLoop();
+  void dispatch(const Responseformat& r);
+  void recordLatency(std::chrono::steady_clock::time_point sent);
+  void failPending();
+
+  typedef std::function<void(const Responseformat& response)> ResponseDecoder;
+  typedef std::function<void(size_t index, int result, const Responseformat& response)> BatchHandler;
+
+  /*!
+   * \brief Sends one command; the future becomes ready once \p decode has run on a successful response.
+   */
+  std::future<int> requestAsync(const Commandformat& w, const ResponseDecoder& decode = ResponseDecoder(),
+                                bool priority = false);
+
+  /*!
+   * \brief Sends \p count commands as one pipelined batch.
+   *
+   * \p on_response is called for every response in FIFO order, each one already checked against
+   * the cmd_id of its request. Once all have arrived the future is set to the result of \p finish; an
+   * empty batch completes at once.
+   *
+   * Without \p wait the batch goes through trySubmit(), and the returned future is not valid() if
+   * it was not sent.
+   */
+  std::future<int> requestBatchAsync(const Commandformat* w, size_t count, const BatchHandler& on_response,
+                                     const std::function<int()>& finish, bool wait = true);
+
+  std::future<int> sendFrames(const Commandformat* frames, size_t count, int* results, bool wait);
+
+  /*!
+   * \brief Encodes command \p Cmd from \p args in the order of its protocol::Layout and sends it.
+   */
+  template <typename Cmd, typename... Args>
+  std::future<int> send(const Args&... args);
+
+  /*!
+   * \brief Sends command \p Cmd and decodes its reply into \p out.
+   */
+  template <typename Cmd, typename Out>
+  std::future<int> query(Out& out);
+
+protected:
+  bool onConnected() override;
+
 public:
   Commander(const std::string& robot_ip, const int port);
   ~Commander();
 
+  static constexpr size_t DEFAULT_PIPELINE_DEPTH = 1;
+
   bool connect();
+  void disconnect();
   bool isRemoteMode();
 
+  /*!
+   * \brief Has \p reactor receive the responses instead of a dedicated thread per connection.
+   *
+   * Call while disconnected; it takes effect on the next connect(). Pass nullptr to go back to a
+   * receiver thread. The reactor must be running and must outlive the connection.
+   */
+  void setReactor(socket::Reactor* reactor);
+
+  void onReadable() override;
+
+  /*!
+   * \brief Sets how many command frames may be in flight on the socket at once.
+   *
+   * A depth of 1 (the default) is strict request/response lockstep. Larger values let batched
+   * calls such as getActualState(), and calls from several threads, share the socket without
+   * waiting for each other's responses.
+   */
+  void setPipelineDepth(size_t depth);
+  size_t getPipelineDepth() const;
+
+  /*!
+   * \brief Returns the time from writing a command to receiving its response, over all commands
+   *        answered since connect() or the last resetLatencyStats().
+   */
+  LatencyStats getLatencyStats();
+  void resetLatencyStats();
+
   int getPermissions();
   int setLogLevel(LogLevels level);
   int setServoAmpState(bool enable);
@@ -87,8 +265,18 @@ public:
   int getExtActualPosition(double (&positions)[3]);
 
   int getMotionState(MotionStatus& status);
+  int getErrorCode(ErrorList& errors);
   int getErrorCode(std::vector<std::string>& error_list);
 
+  /*!
+   * \brief Reads position, RPM, current, motion state and error list as one pipelined batch.
+   *
+   * With \p external_axes set, the external axis position and RPM are part of the same batch.
+   *
+   * \return 0 on success, otherwise the first non-zero result of the batch
+   */
+  int getActualState(ActualState& state, bool external_axes = false);
+
   int ptpJoint(double* positions);
   int ptpJoint(double* positions, double acc_time, double ratio);
   int linearSplinePoint(const double* positions, double goal_time_sec);
@@ -97,6 +285,10 @@ public:
                        double goal_time_sec);
   int extPtpJoint(double* positions);
 
+  /*
+   * motionAbort() and setServoAmpState(false) take the priority lane: they overtake frames other
+   * threads are still waiting to send, however full the pipeline is.
+   */
   int motionAbort();
   int clearError();
 
@@ -109,6 +301,72 @@ public:
   int getRobotMode(ControlMode& mode);
   int GetRobotVersion(std::string& str);
   int GetHRSSVersion(std::string& str);
+
+  /*
+   * Asynchronous variants. Each one returns as soon as its frame is written (blocking only while the
+   * pipeline is full) and the future holds the same result code as the synchronous call. Output
+   * arguments are written before the future becomes ready and must stay valid until then. Futures
+   * are completed from the receiver thread, so do not wait on one from inside another's completion.
+   */
+  std::future<int> isRemoteModeAsync(bool& remote_mode);
+
+  std::future<int> getPermissionsAsync();
+  std::future<int> setLogLevelAsync(LogLevels level);
+  std::future<int> setServoAmpStateAsync(bool enable);
+  std::future<int> getServoAmpStateAsync(bool& enable);
+
+  std::future<int> getActualRPMAsync(double (&velocities)[6]);
+  std::future<int> getActualPositionAsync(double (&positions)[6]);
+  std::future<int> getActualCurrentAsync(double (&efforts)[6]);
+
+  std::future<int> getExtActualRPMAsync(double (&velocities)[3]);
+  std::future<int> getExtActualPositionAsync(double (&positions)[3]);
+
+  std::future<int> getMotionStateAsync(MotionStatus& status);
+  std::future<int> getErrorCodeAsync(ErrorList& errors);
+  std::future<int> getErrorCodeAsync(std::vector<std::string>& error_list);
+  std::future<int> getActualStateAsync(ActualState& state, bool external_axes = false);
+
+  std::future<int> ptpJointAsync(double* positions);
+  std::future<int> ptpJointAsync(double* positions, double acc_time, double ratio);
+  std::future<int> linearSplinePointAsync(const double* positions, double goal_time_sec);
+  std::future<int> CubicSplinePointAsync(const double* positions, const double* velocities, double goal_time_sec);
+  std::future<int> QuintSplinePointAsync(const double* positions, const double* velocities,
+                                         const double* acceleration, double goal_time_sec);
+  std::future<int> extPtpJointAsync(double* positions);
+
+  /*!
+   * \brief Sends frames encoded beforehand as one pipelined batch, in as few writes as the pipeline allows.
+   *
+   * If \p results is given, it receives the result of every frame. The future holds the first
+   * non-zero one, or 0. \p frames and \p results must stay valid until the future is ready.
+   */
+  std::future<int> sendFramesAsync(const Commandformat* frames, size_t count, int* results = nullptr);
+
+  /*!
+   * \brief Sends frames like sendFramesAsync(), unless that would block.
+   *
+   * The frames go out in one write only if the pipeline has room for all of them, no priority
+   * command is waiting and no other thread is writing; otherwise nothing is sent. A closed
+   * connection takes the frames and fails them, as sendFramesAsync() does.
+   *
+   * \return false if nothing was sent; \p result is set to the batch's future otherwise
+   */
+  bool trySendFramesAsync(const Commandformat* frames, size_t count, std::future<int>& result,
+                          int* results = nullptr);
+
+  std::future<int> motionAbortAsync();
+  std::future<int> clearErrorAsync();
+
+  std::future<int> setPtpSpeedAsync(int ratio);
+  std::future<int> getPtpSpeedAsync(int& ratio);
+  std::future<int> setOverrideRatioAsync(int ratio);
+  std::future<int> getOverrideRatioAsync(int& ratio);
+
+  std::future<int> setRobotModeAsync(ControlMode mode);
+  std::future<int> getRobotModeAsync(ControlMode& mode);
+  std::future<int> GetRobotVersionAsync(std::string& str);
+  std::future<int> GetHRSSVersionAsync(std::string& str);
 };
 
 }  // namespace hrsdk
@@ -0,0 +1,66 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_DECIMATION_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_DECIMATION_HPP_
+
+#include <vector>
+
+#include "hiwin_robot_client_library/trajectory.hpp"
+
+namespace hrsdk
+{
+/*!
+ * \brief Finds the points of a dense trajectory that the spline command needs to follow it closely.
+ *
+ * Douglas-Peucker in joint space: the spline of \p type between two kept points is evaluated at
+ * the times of every point in between, and the one deviating most is kept too, until no axis of
+ * any dropped point is off by more than its tolerance. The spline uses the positions, and for
+ * cubic and quintic trajectories the velocities and accelerations, of the kept points, with the
+ * goal times of the dropped points added up. Deviation is checked at the dropped points only.
+ *
+ * \param trajectory Timed trajectory, as sent to HIWINDriver::writeTrajectory
+ * \param tolerances Largest position error of each axis, one per axis of \p trajectory [rad]
+ * \param kept Receives the indices of the points to send, ascending; the first and last are always kept
+ * \return false if a tolerance is not positive or the trajectory has no axes
+ */
+bool decimateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const double* tolerances,
+                        std::vector<size_t>& kept);
+
+/*!
+ * \brief Copies the points decimateTrajectory() keeps into \p decimated, summing up the goal times
+ *        of the dropped ones.
+ *
+ * \p decimated may be \p trajectory itself.
+ */
+bool decimateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const double* tolerances,
+                        TrajectoryBuffer& decimated);
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_DECIMATION_HPP_
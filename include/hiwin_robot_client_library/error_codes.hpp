@@ -0,0 +1,77 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_ERROR_CODES_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_ERROR_CODES_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace hrsdk
+{
+/*!
+ * \brief Controller errors as reported by GetErrorCode.
+ *
+ * A code packs the three bytes of its "ErrXX-YY-ZZ" text form as 0xXXYYZZ. Strings are only
+ * produced by formatErrorCode(), for logs and user interfaces.
+ */
+struct ErrorList
+{
+  // (248 data words - 4 header words) / 4 words per entry
+  static const size_t CAPACITY = 61;
+
+  size_t count;
+  int32_t codes[CAPACITY];
+
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  /// Most recent error, 0 if there is none
+  int32_t back() const
+  {
+    return count == 0 ? 0 : codes[count - 1];
+  }
+};
+
+/*!
+ * \brief Returns \p code in the controller's "ErrXX-YY-ZZ" form.
+ */
+inline std::string formatErrorCode(int32_t code)
+{
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "Err%02x-%02x-%02x", (code >> 16) & 0xFF, (code >> 8) & 0xFF, code & 0xFF);
+  return std::string(buffer);
+}
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_ERROR_CODES_HPP_
@@ -29,6 +29,10 @@
 #ifndef HIWIN_ROBOT_CLIENT_LIBRARY_EVENT_CB_HPP_
 #define HIWIN_ROBOT_CLIENT_LIBRARY_EVENT_CB_HPP_
 
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
 #include <hiwin_robot_client_library/socket/tcp_client.hpp>
 
 namespace hrsdk
@@ -39,6 +43,8 @@ private:
   std::string robot_ip_;
   int port_;
 
+  std::function<void(const uint8_t* data, size_t len)> event_handler_;
+
 public:
   EventCb(const std::string& robot_ip, const int port)
   {
@@ -65,6 +71,32 @@ public:
 
     return true;
   }
+
+  /*!
+   * \brief Sets the function receiving raw event data when the socket is driven by a Reactor.
+   *
+   * Without a handler the data is dropped, as nothing else reads this socket.
+   */
+  void setEventHandler(const std::function<void(const uint8_t* data, size_t len)>& handler)
+  {
+    event_handler_ = handler;
+  }
+
+  void onReadable() override
+  {
+    receiveAvailable();
+
+    uint8_t chunk[1024];
+    size_t len;
+    while ((len = std::min(receiveBuffered(), sizeof(chunk))) > 0)
+    {
+      takeFrame(chunk, len);
+      if (event_handler_)
+      {
+        event_handler_(chunk, len);
+      }
+    }
+  }
 };
 }  // namespace hrsdk
 
@@ -65,6 +65,15 @@ public:
 
     return true;
   }
+
+  /*!
+   * \brief Nothing reads file transfers yet, so data delivered by a Reactor is discarded.
+   */
+  void onReadable() override
+  {
+    receiveAvailable();
+    resetReceiveBuffer();
+  }
 };
 }  // namespace hrsdk
 
@@ -29,7 +29,13 @@
 #ifndef HIWIN_ROBOT_CLIENT_LIBRARY_HIWIN_DRIVER_HPP_
 #define HIWIN_ROBOT_CLIENT_LIBRARY_HIWIN_DRIVER_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 
@@ -37,12 +43,128 @@
 #include <hiwin_robot_client_library/commander.hpp>
 #include <hiwin_robot_client_library/event_cb.hpp>
 #include <hiwin_robot_client_library/file_client.hpp>
+#include <hiwin_robot_client_library/mailbox.hpp>
+#include <hiwin_robot_client_library/online_trajectory.hpp>
+#include <hiwin_robot_client_library/seqlock.hpp>
+#include <hiwin_robot_client_library/trajectory.hpp>
+#include <hiwin_robot_client_library/trajectory_validation.hpp>
 
 namespace hrsdk
 {
 static const int COMMAND_PORT = 1503;
 static const int EVENT_PORT = 1504;
 static const int FILE_PORT = 1505;
+static const size_t COMMAND_PIPELINE_DEPTH = 8;
+
+/// Controller version, parsed once at connect from the HRDLL (or else HRSS) version string
+struct RobotVersion
+{
+  int major;
+  int minor;
+  int patch;
+};
+
+// Trajectory streaming, see HIWINDriver::writeTrajectory
+static const size_t DEFAULT_TRAJECTORY_WINDOW = COMMAND_PIPELINE_DEPTH;  // Unacknowledged points
+static const double DEFAULT_TRAJECTORY_LOOKAHEAD = 0.5;                 // [s] of motion sent ahead
+static const std::chrono::milliseconds TRAJECTORY_POLL_PERIOD(10);
+
+/// Returned by HIWINDriver::writeTrajectory when the controller stopped executing the trajectory
+static const int MOTION_STOPPED = -2;
+
+/// Returned by HIWINDriver::writeTrajectory when the trajectory breaks the joint limits; nothing was sent
+static const int LIMIT_VIOLATION = -3;
+
+/*!
+ * \brief Outcome of HIWINDriver::writeTrajectory.
+ *
+ * Points already sent behind a rejected one are not counted even if the controller accepted
+ * them; the motion is aborted so they do not run.
+ */
+struct TrajectoryResult
+{
+  int result;           // 0 if every point was accepted, else the result of the first failure
+  size_t acknowledged;  // Points accepted by the controller, all of them before failed_index
+  size_t failed_index;  // Index of the first point that failed, the point count if none did
+};
+
+typedef std::function<void(size_t acknowledged, size_t total)> TrajectoryProgressCallback;
+
+/// Options of the setpoint streaming thread, see HIWINDriver::startStreaming
+struct StreamingOptions
+{
+  std::chrono::nanoseconds period;
+  TrajectoryType type;
+  int priority;      // SCHED_FIFO priority of the thread, 0 keeps the default scheduler
+  int cpu;           // CPU to pin the thread to, -1 for any
+  bool lock_memory;  // mlockall() the process so the thread never waits on a page fault
+};
+
+/// Timing of the setpoint streaming thread, see HIWINDriver::getStreamingStats
+struct StreamingStats
+{
+  uint64_t cycles;           // Periods elapsed, missed ones included
+  uint64_t sent;             // Setpoints written to the controller
+  uint64_t idle;             // Cycles without a new setpoint to send
+  uint64_t throttled;        // Cycles a new setpoint waited because the trajectory window was full
+  uint64_t overruns;         // Cycles a setpoint waited because other commands held the command pipeline
+  uint64_t dropped;          // Setpoints replaced by a newer one before they could be sent
+  uint64_t coalesced;        // Sends that replaced at least one older setpoint
+  uint64_t deadline_misses;  // Periods skipped because the thread woke up past the next deadline
+  uint64_t failures;         // Setpoints that were rejected or could not be sent
+  int64_t last_lateness_ns;  // Wake-up delay behind the deadline
+  int64_t max_lateness_ns;
+  int last_result;
+};
+
+/// State of each socket of a HIWINDriver, see HIWINDriver::getConnectionStatus
+struct ConnectionStatus
+{
+  socket::SocketState command;
+  socket::SocketState event;
+  socket::SocketState file;
+};
+
+/// Result of each command HIWINDriver::connect sends to bring the robot up, in the order sent
+struct BringUpStatus
+{
+  enum Step
+  {
+    RobotVersion = 0,
+    Permissions,
+    LogLevel,
+    RobotMode,
+    PtpSpeed,
+    OverrideRatio,
+    ServoAmp,
+    STEP_COUNT
+  };
+
+  int results[STEP_COUNT];
+};
+
+/// Robot state read by HIWINDriver::readState in a single batched exchange
+struct RobotStateSnapshot
+{
+  static const size_t MAX_AXES = 9;
+
+  size_t axis_count;  // Number of used entries in the joint arrays (6 to 9)
+  double positions[MAX_AXES];
+  double velocities[MAX_AXES];
+  double efforts[MAX_AXES];  // External axes report no current and read as 0
+  bool in_motion;
+  bool in_error;
+  int32_t error_code;  // Last reported error, encoded as by HIWINDriver::getErrorCode
+
+  // Whether the matching fields above hold data from this read
+  bool position_valid;
+  bool velocity_valid;
+  bool effort_valid;
+  bool motion_valid;
+  bool error_valid;
+
+  int64_t stamp_ns;  // steady_clock time halfway through the exchange
+};
 
 class HIWINDriver
 {
@@ -50,32 +172,310 @@ private:
   std::string robot_ip_;  // IP address of the robot
   std::string version_info_;
   std::string version_number_;
+  RobotVersion version_;
+
+  // Arm PTP targets go out as PtpJointWithVelocity while set, see setPtpProfile
+  struct PtpProfile
+  {
+    bool set;
+    double acc_time;
+    double ratio;
+  };
+  // Read by the streaming thread, so the pair is published as a whole
+  SeqLock<PtpProfile> ptp_profile_;
+
+  std::atomic<size_t> trajectory_window_;
+  std::atomic<double> trajectory_lookahead_;
+  JointLimits joint_limits_;
 
   std::unique_ptr<hrsdk::Commander> commander_;
   std::unique_ptr<hrsdk::EventCb> event_cb_;
   std::unique_ptr<hrsdk::FileClient> file_client_;
+  hrsdk::socket::Reactor* reactor_;
+  std::chrono::milliseconds connect_timeout_;
+  BringUpStatus bring_up_status_;
+
+  // Sends the bring-up commands as one pipelined batch and waits for all of them
+  bool bringUp();
+
+  void detachReactor();
+
+  // Parses version_info_ into version_ and version_number_
+  void parseVersion();
+
+  // Background state monitor, see startMonitor()
+  std::thread monitor_thread_;
+  std::atomic<bool> monitor_running_;
+  std::chrono::microseconds monitor_period_;
+  size_t monitor_axes_;
+  SeqLock<RobotStateSnapshot> monitored_state_;
+
+  void monitorLoop();
+  bool loadMonitoredState(RobotStateSnapshot& state, size_t axis_count);
+
+  // Setpoint streaming thread, see startStreaming()
+  std::thread streaming_thread_;
+  std::atomic<bool> streaming_running_;
+  StreamingOptions streaming_options_;
+  SeqLock<StreamingStats> streaming_stats_;
+
+  // A spline point of the streaming type or, with joint_axes set, a joint PTP target of that many axes
+  struct Setpoint
+  {
+    TrajectoryPoint point;
+    size_t joint_axes;
+  };
+  Mailbox<Setpoint> setpoint_;
+
+  // Set while the streaming thread generates its setpoints, see startOnlineTrajectory()
+  std::unique_ptr<OnlineTrajectoryGenerator> online_generator_;
+  Mailbox<TrajectoryPoint> online_target_;
+
+  bool launchStreaming(const StreamingOptions& options);
+  void streamingLoop();
+
+  // Encodes a joint PTP target as writeJointCommand() sends it
+  void encodeJointCommand(Commandformat& w, const double* positions, size_t axis_count) const;
+
+  static bool fillSnapshot(const ActualState& actual, size_t axis_count,
+                           std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+                           RobotStateSnapshot& state);
 
 public:
   HIWINDriver(const std::string& robot_ip);
   ~HIWINDriver();
 
+  static constexpr std::chrono::milliseconds DEFAULT_CONNECT_TIMEOUT{ 5000 };
+
+  /*!
+   * \brief Connects the command, event and file sockets and brings the robot up.
+   *
+   * The three sockets are dialled in parallel and must all be connected within the connect
+   * timeout. Use getConnectionStatus() to find out which one failed, and getBringUpStatus() when
+   * the sockets connected but the robot did not come up.
+   */
   bool connect();
   bool connect(int command_port, int event_port, int file_port);
+
+  /*!
+   * \brief First half of connect(): creates the three sockets and starts dialling them.
+   *
+   * The sockets are appended to \p clients. Complete them with socket::TCPClient::connectAll(),
+   * possibly together with those of other drivers, then call finishConnect().
+   *
+   * Reconnecting replaces the sockets of the previous connection, so a running monitor or
+   * streaming thread is stopped first and has to be started again afterwards.
+   */
+  void beginConnect(int command_port, int event_port, int file_port, std::vector<socket::TCPClient*>& clients);
+
+  /*!
+   * \brief Second half of connect(): brings the robot up once its sockets are connected.
+   *
+   * \return false if any of the three sockets is not connected or a bring-up command failed, see
+   *         getBringUpStatus()
+   */
+  bool finishConnect();
   void disconnect();
 
+  /*!
+   * \brief Sets how long connect() waits for all three sockets together.
+   */
+  void setConnectTimeout(std::chrono::milliseconds timeout);
+  ConnectionStatus getConnectionStatus();
+
+  /*!
+   * \brief Returns the result of every bring-up command of the last connect(), 0 meaning success.
+   */
+  BringUpStatus getBringUpStatus() const;
+
+  /*!
+   * \brief Lets \p reactor service the command, event and file sockets instead of a receiver thread.
+   *
+   * Call before connect(). Several drivers can share one running reactor, which must outlive them.
+   */
+  void setReactor(hrsdk::socket::Reactor* reactor);
+
   void getRobotVersion(std::string& version);
-  bool isVersionGreaterOrEqual(const std::string& requiredVersion);
+  RobotVersion getRobotVersion() const;
+  bool isVersionGreaterOrEqual(const std::string& requiredVersion) const;
+  bool isVersionGreaterOrEqual(const RobotVersion& required) const;
 
+  /*!
+   * \brief Moves to \p positions with a joint PTP motion at the controller's PTP speed.
+   *
+   * Once setPtpProfile() was called, arm-only targets use PtpJointWithVelocity and that profile
+   * instead. Targets including external axes always use the controller's PTP speed.
+   */
   void writeJointCommand(const std::vector<double>& positions);
+
+  /*!
+   * \brief Sends arm PTP motions as PtpJointWithVelocity, with acceleration time \p acc_time [s]
+   * and speed ratio \p ratio [%].
+   *
+   * May be called while streaming, which uses the new profile from its next joint target on.
+   * This and clearPtpProfile() must not be called from several threads at once.
+   */
+  void setPtpProfile(double acc_time, double ratio);
+
+  /*!
+   * \brief Goes back to plain PtpJoint motions at the controller's PTP speed, the default.
+   */
+  void clearPtpProfile();
   void writeTrajectorySplinePoint(const std::vector<double>& positions, const float goal_time);
   void writeTrajectorySplinePoint(const std::vector<double>& positions, const std::vector<double>& velocities,
                                   const float goal_time);
   void writeTrajectorySplinePoint(const std::vector<double>& positions, const std::vector<double>& velocities,
                                   const std::vector<double>& accelerations, const float goal_time);
 
+  /*!
+   * \brief Streams a whole trajectory, pipelining the points instead of waiting for each one.
+   *
+   * At most the trajectory window of points is unacknowledged at any time. On top of that, no
+   * more than the lookahead of motion time is sent ahead of what the controller has executed.
+   * Executed time is estimated from the wall clock while getMotionState reports the robot moving:
+   * it pauses while the motion is on hold and streaming stops with MOTION_STOPPED once the servos
+   * are off. Streaming also stops at the first point the controller rejects. Up to a window of
+   * points behind it may already be on their way by then; the controller could accept those and
+   * run the trajectory with a gap, so the motion is aborted in that case.
+   *
+   * Once joint limits are set, a trajectory that breaks them is not sent at all: the result is
+   * LIMIT_VIOLATION and failed_index the first offending point, see checkTrajectory().
+   *
+   * \param on_progress Called after every acknowledged point, may be empty
+   */
+  TrajectoryResult writeTrajectory(const std::vector<TrajectoryPoint>& points, TrajectoryType type,
+                                   const TrajectoryProgressCallback& on_progress = TrajectoryProgressCallback());
+
+  /*!
+   * \brief Streams a trajectory compiled beforehand, e.g. by a TrajectoryCache, without encoding it again.
+   *
+   * Same flow control as writeTrajectory() above. Whatever the window and lookahead allow to go
+   * out at once is written in a single call.
+   */
+  TrajectoryResult writeTrajectory(const CompiledTrajectory& trajectory,
+                                   const TrajectoryProgressCallback& on_progress = TrajectoryProgressCallback());
+
+  /*!
+   * \brief Sets how many points writeTrajectory() keeps unacknowledged and how many seconds of
+   *        motion it may send ahead of the controller.
+   *
+   * A writeTrajectory() call already running keeps the values it started with; the streaming
+   * thread picks up the new window with its next cycle.
+   */
+  void setTrajectoryStreaming(size_t window, double lookahead);
+
+  /*!
+   * \brief Sets the limits writeTrajectory() checks every trajectory against before sending it.
+   *
+   * With an axis_count of 0, the default, trajectories are sent unchecked. Set it while no
+   * trajectory is being written.
+   *
+   * \return false, keeping the previous limits, if axis_count is above TRAJECTORY_MAX_AXES
+   */
+  bool setJointLimits(const JointLimits& limits);
+
+  /*!
+   * \brief Checks \p points against the joint limits, as writeTrajectory() does.
+   *
+   * \return false, with the first offending point in \p violation, if a limit is broken
+   */
+  bool checkTrajectory(const std::vector<TrajectoryPoint>& points, TrajectoryType type,
+                       TrajectoryViolation& violation) const;
+
+  /*!
+   * \brief Starts a thread that sends the latest setpoint every period of \p options.
+   *
+   * The thread sleeps to absolute deadlines, so jitter in one cycle does not shift the next ones.
+   * A cycle without a new setpoint since the last one sends nothing. Setpoints published before
+   * the call are ignored. A goal_time of 0 in a setpoint stands for one period. Scheduling,
+   * affinity or memory locking that cannot be applied, usually for lack of privileges, is
+   * reported and the thread runs without it.
+   *
+   * Other commands may be issued meanwhile. The thread never waits for them: while they fill the
+   * command pipeline, its setpoint is held back to a later cycle and counted as an overrun.
+   */
+  bool startStreaming(const StreamingOptions& options);
+  void stopStreaming();
+  bool isStreaming() const;
+
+  /*!
+   * \brief Publishes the setpoint for the next streaming cycle, replacing any not sent yet.
+   *
+   * Never blocks on the streaming thread, so it can be called at any rate. Setpoints, joint ones
+   * included, must all come from the same thread.
+   */
+  void setSetpoint(const TrajectoryPoint& point);
+
+  /*!
+   * \brief Publishes a joint PTP target for the next streaming cycle, replacing any setpoint not sent yet.
+   *
+   * The streaming thread sends it as writeJointCommand() would. Meant for perception loops that
+   * produce targets faster than the controller takes them: only the newest one goes out. Call it
+   * from the thread that publishes the other setpoints.
+   */
+  void setJointSetpoint(const std::vector<double>& positions);
+
+  StreamingStats getStreamingStats() const;
+
+  /*!
+   * \brief Starts the streaming thread with an OnlineTrajectoryGenerator producing the setpoints.
+   *
+   * Every period the generator advances from its last state towards the latest target, and the
+   * new state goes out as a quintic spline point with the period as goal time. Nothing is sent
+   * once the robot rests at the target. \p start is where the robot is at the moment, normally
+   * at rest; it is also the first target. Stop it with stopStreaming().
+   */
+  bool startOnlineTrajectory(const JointLimits& limits, const TrajectoryPoint& start,
+                             const StreamingOptions& options);
+
+  /*!
+   * \brief Publishes the positions the online trajectory moves to from the next cycle on.
+   *
+   * Only the positions of \p target are used. Never blocks, so a vision loop can retarget at any rate,
+   * but targets must all come from the same thread.
+   */
+  void setOnlineTarget(const TrajectoryPoint& target);
+
   void motionAbort();
   void clearError();
 
+  /*!
+   * \brief Reads joint position, velocity, effort, motion and error state in one batched exchange.
+   *
+   * \param axis_count 6 for the robot arm, up to 9 to include the external axes
+   * \return true if every field of \p state is valid
+   */
+  bool readState(RobotStateSnapshot& state, size_t axis_count = 6);
+
+  /*!
+   * \brief Sends the requests of readState() and returns without waiting for the responses.
+   *
+   * \p state is filled in when the future is waited on, so it has to stay alive until then, and the
+   * end of the exchange is stamped at that point too. Lets a caller have the reads of many robots
+   * in flight at once.
+   */
+  std::future<bool> readStateAsync(RobotStateSnapshot& state, size_t axis_count = 6);
+
+  /// Round-trip statistics of the command socket, see Commander::getLatencyStats
+  LatencyStats getLatencyStats();
+
+  /*!
+   * \brief Starts a thread that calls readState() every \p period and publishes the result.
+   *
+   * While the monitor runs, getJointPosition(), getJointVelocity(), getJointEffort(), isInMotion()
+   * and isInError() return the latest published snapshot instead of querying the controller.
+   */
+  bool startMonitor(std::chrono::microseconds period, size_t axis_count = 6);
+  void stopMonitor();
+  bool isMonitorRunning() const;
+
+  /*!
+   * \brief Copies the latest snapshot published by the monitor.
+   *
+   * \return false if the monitor has not published anything yet
+   */
+  bool getMonitoredState(RobotStateSnapshot& state) const;
+
   void getJointVelocity(std::vector<double>& velocities);
   void getJointEffort(std::vector<double>& efforts);
   void getJointPosition(std::vector<double>& positions);
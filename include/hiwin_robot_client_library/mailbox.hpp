@@ -0,0 +1,115 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_MAILBOX_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_MAILBOX_HPP_
+
+#include <cstdint>
+
+#include "hiwin_robot_client_library/seqlock.hpp"
+
+namespace hrsdk
+{
+/*!
+ * \brief Latest-wins mailbox from one producer thread to one consumer thread.
+ *
+ * A post replaces whatever the consumer has not taken yet instead of queueing behind it, so a
+ * consumer slower than its producer always gets the newest value and never falls behind.
+ * Neither side ever waits for the other: a take() that races a post() gives up and finds the
+ * value on its next call. The values that were replaced unseen are counted as dropped, and
+ * every take that skipped at least one of them as coalesced. post() belongs to the producer
+ * thread; take(), clear() and the counters belong to the consumer thread.
+ */
+template <typename T>
+class Mailbox
+{
+private:
+  SeqLock<T> slot_;
+  uint64_t taken_;  // Version of the last value taken or cleared
+  uint64_t dropped_;
+  uint64_t coalesced_;
+
+public:
+  Mailbox() : taken_(0), dropped_(0), coalesced_(0)
+  {
+  }
+
+  void post(const T& value)
+  {
+    slot_.store(value);
+  }
+
+  /// Whether a value was posted since the last take() or clear()
+  bool hasNew() const
+  {
+    return slot_.version() != taken_;
+  }
+
+  /*!
+   * \brief Takes the latest value, if one was posted since the last take() or clear().
+   *
+   * \return false, leaving \p value untouched, if there is nothing new or a post is in progress.
+   *         In the latter case the value stays new for the next call.
+   */
+  bool take(T& value)
+  {
+    uint64_t version;
+    if (!hasNew() || !slot_.tryLoad(value, version))
+    {
+      return false;
+    }
+
+    const uint64_t skipped = version - taken_ - 1;
+    dropped_ += skipped;
+    coalesced_ += skipped > 0 ? 1 : 0;
+    taken_ = version;
+    return true;
+  }
+
+  /// Discards what has been posted so far, without counting it, and zeroes the counters
+  void clear()
+  {
+    taken_ = slot_.version();
+    dropped_ = 0;
+    coalesced_ = 0;
+  }
+
+  uint64_t dropped() const
+  {
+    return dropped_;
+  }
+
+  uint64_t coalesced() const
+  {
+    return coalesced_;
+  }
+};
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_MAILBOX_HPP_
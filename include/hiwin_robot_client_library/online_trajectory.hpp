@@ -0,0 +1,86 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_ONLINE_TRAJECTORY_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_ONLINE_TRAJECTORY_HPP_
+
+#include "hiwin_robot_client_library/trajectory.hpp"
+
+namespace hrsdk
+{
+/*!
+ * \brief Generates a jerk-limited motion towards a target that may change at any cycle.
+ *
+ * Every update() advances the state by one cycle at constant jerk, so consecutive states are
+ * joined exactly by the quintic spline command and can be sent as quintic points with the cycle
+ * time as goal time. Each axis brakes in time to stop at its target and keeps within its
+ * velocity, acceleration and jerk limits; axes move independently and need not arrive together.
+ * The last three cycles of each axis are solved to end exactly at rest on the target, so arriving
+ * takes no jump either.
+ * A new target is blended into from the current state, without stopping first.
+ *
+ * update() runs in constant time and does not allocate, so it can run in a real-time loop.
+ */
+class OnlineTrajectoryGenerator
+{
+private:
+  JointLimits limits_;
+  double cycle_time_;
+  TrajectoryPoint state_;
+  double target_[TRAJECTORY_MAX_AXES];
+  bool settled_;
+
+public:
+  /*!
+   * \param limits Limits of the axes to move; axes past TRAJECTORY_MAX_AXES are ignored
+   * \param cycle_time Time each update() advances by [s]
+   */
+  OnlineTrajectoryGenerator(const JointLimits& limits, double cycle_time);
+
+  /*!
+   * \brief Sets the current state and makes it the target, e.g. from the measured robot state.
+   */
+  void reset(const TrajectoryPoint& state);
+
+  /// Sets the positions to move to; the first axis_count entries of \p positions are used
+  void setTarget(const double* positions);
+
+  /*!
+   * \brief Advances one cycle and writes the new state, with the cycle time as goal_time, to \p next.
+   *
+   * \return false, leaving \p next untouched, if every axis already rests at its target
+   */
+  bool update(TrajectoryPoint& next);
+
+  const TrajectoryPoint& getState() const;
+  bool isSettled() const;
+};
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_ONLINE_TRAJECTORY_HPP_
@@ -0,0 +1,465 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_PROTOCOL_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_PROTOCOL_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <hiwin_robot_client_library/error_codes.hpp>
+
+namespace hrsdk
+{
+enum class SpaceOperationTypes
+{
+  Cartesian = 0,
+  Joint,
+  Tool,
+};
+
+enum class CommandType
+{
+  Get = 0,
+  Set,
+  MonitorSet,
+};
+
+enum class CommandId : uint16_t
+{
+  GetPermissions = 0x000A,
+  SetPtpSpeed = 0x0096,
+  GetPtpSpeed = 0x0098,
+  SetOverRideRatio = 0x012C,
+  GetOverRideRatio = 0x012D,
+  SetServoAmp = 0x0578,
+  GetServoAmp = 0x0579,
+  GetRobotVersion = 0x057A,
+  SetRobotMode = 0x058C,
+  GetRobotMode = 0x058D,
+  ControllerReset = 0x05AA,
+  PtpJoint = 0x07D2,
+  PtpJointWithVelocity = 0x07D6,
+  LinearSplinePoint = 0x07E8,
+  CubicSplinePoint = 0x07E9,
+  QuinticSplinePoint = 0x07EA,
+  ExtPtpJoint = 0x07EF,
+  MotionAbort = 0x07FA,
+  GetExtActualRPM = 0x0863,
+  GetExtActualPosition = 0x0864,
+  GetActualPosition = 0x0866,
+  GetActualRPM = 0x0867,
+  GetErrorCode = 0x086C,
+  GetMotionState = 0x086D,
+  SetLogLevel = 0x1003,
+  GetActualCurrent = 0x100A,
+  GetHRSSVersion = 0x100B,
+  GetHrssMode = 0x1036,
+};
+
+static const size_t COMMAND_PARAM_WORDS = 249;
+static const size_t RESPONSE_DATA_WORDS = 248;
+
+struct Commandformat
+{
+  uint16_t cmd_id;
+  uint16_t param[COMMAND_PARAM_WORDS];
+} __attribute__((__packed__));
+
+struct Responseformat
+{
+  uint16_t cmd_id;
+  uint16_t result;
+  uint16_t data[RESPONSE_DATA_WORDS];
+} __attribute__((__packed__));
+
+/*!
+ * \brief Compile-time description of every command frame.
+ *
+ * A command is a CommandId plus a list of fields, each of which knows which parameter words it
+ * fills and how to scale its argument. Queries add a reply decoder. The Commander drives all of
+ * them through the same encode and decode path, which the compiler specialises per command.
+ */
+namespace protocol
+{
+static inline void writeInt32(Commandformat& w, size_t index, int32_t value)
+{
+  std::memcpy(&w.param[index], &value, sizeof(int32_t));
+}
+
+static inline int32_t readInt32(const Responseformat& r, size_t index)
+{
+  int32_t value;
+  std::memcpy(&value, &r.data[index], sizeof(int32_t));
+  return value;
+}
+
+static inline int32_t toMilliDegrees(double radians)
+{
+  return static_cast<int32_t>(std::round(radians * (180 / M_PI) * 1000.0));
+}
+
+static inline double fromMilliDegrees(int32_t millidegrees)
+{
+  return (millidegrees / 1000.0) * (M_PI / 180);
+}
+
+/*!
+ * \brief Converts \p count radians to millidegrees, two at a time with SSE2 where available.
+ *
+ * Gives bit for bit the result of the scalar toMilliDegrees(). Works on any contiguous run of
+ * values, such as one axis of a structure-of-arrays trajectory buffer.
+ */
+void toMilliDegrees(const double* radians, int32_t* millidegrees, size_t count);
+
+/// Batch counterpart of fromMilliDegrees(), bit for bit equal to it
+void fromMilliDegrees(const int32_t* millidegrees, double* radians, size_t count);
+
+static inline int32_t toMilli(double value)
+{
+  return static_cast<int32_t>(std::round(value * 1000.0));
+}
+
+/// Enough for any double printed with "%.7f", sign included
+static const size_t FIXED7_BUFFER_SIZE = 320;
+
+/*!
+ * \brief Formats \p value exactly like printf("%.7f") without touching the heap.
+ *
+ * \return Number of characters written to \p buffer, which is not null terminated
+ */
+size_t formatFixed7(double value, char* buffer);
+
+constexpr size_t maxWords(size_t a, size_t b)
+{
+  return a > b ? a : b;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Request fields. END is one past the last parameter word a field writes.
+// ---------------------------------------------------------------------------------------------
+
+/// Constant parameter word, takes no argument
+template <size_t Index, uint16_t Value>
+struct Fixed
+{
+  static constexpr size_t END = Index + 1;
+};
+
+/// One parameter word holding an enum, flag or small integer
+template <size_t Index>
+struct Word
+{
+  static constexpr size_t END = Index + 1;
+
+  template <typename T>
+  static void encode(Commandformat& w, T value)
+  {
+    w.param[Index] = static_cast<uint16_t>(value);
+  }
+};
+
+/// Value in thousandths as int32
+template <size_t Index>
+struct Milli
+{
+  static constexpr size_t END = Index + 2;
+
+  static void encode(Commandformat& w, double value)
+  {
+    writeInt32(w, Index, toMilli(value));
+  }
+};
+
+/// \p Count joint values in radians, sent as int32 millidegrees
+template <size_t Index, size_t Count>
+struct MilliDegrees
+{
+  static constexpr size_t END = Index + 2 * Count;
+
+  static void encode(Commandformat& w, const double* radians)
+  {
+    int32_t millidegrees[Count];
+    toMilliDegrees(radians, millidegrees, Count);
+    std::memcpy(&w.param[Index], millidegrees, sizeof(millidegrees));
+  }
+};
+
+/// \p Count joint values in radians, sent as comma separated degrees with one character per word
+template <size_t Index, size_t Count>
+struct AsciiDegrees
+{
+  static constexpr size_t END = COMMAND_PARAM_WORDS;
+
+  static void encode(Commandformat& w, const double* radians)
+  {
+    char text[FIXED7_BUFFER_SIZE];
+    size_t word = Index + 1;
+    for (size_t i = 0; i < Count; i++)
+    {
+      if (i != 0 && word < COMMAND_PARAM_WORDS)
+      {
+        w.param[word++] = ',';
+      }
+
+      size_t length = formatFixed7(radians[i] * (180 / M_PI), text);
+      for (size_t c = 0; c < length && word < COMMAND_PARAM_WORDS; c++)
+      {
+        w.param[word++] = static_cast<uint16_t>(text[c]);
+      }
+    }
+
+    // The length word in front of the characters
+    w.param[Index] = static_cast<uint16_t>(word - Index - 1);
+    std::memset(&w.param[word], 0, (COMMAND_PARAM_WORDS - word) * sizeof(uint16_t));
+  }
+};
+
+/*!
+ * \brief Encodes a field list, handing each argument-taking field the next argument.
+ *
+ * Fields have to cover every word below WORDS, so the frame needs no zeroing up front.
+ */
+template <typename... Fields>
+struct Layout;
+
+template <>
+struct Layout<>
+{
+  static constexpr size_t WORDS = 0;
+
+  static void encode(Commandformat&)
+  {
+  }
+};
+
+template <size_t Index, uint16_t Value, typename... Rest>
+struct Layout<Fixed<Index, Value>, Rest...>
+{
+  static constexpr size_t WORDS = maxWords(Index + 1, Layout<Rest...>::WORDS);
+
+  template <typename... Args>
+  static void encode(Commandformat& w, const Args&... args)
+  {
+    w.param[Index] = Value;
+    Layout<Rest...>::encode(w, args...);
+  }
+};
+
+template <typename Field, typename... Rest>
+struct Layout<Field, Rest...>
+{
+  static constexpr size_t WORDS = maxWords(Field::END, Layout<Rest...>::WORDS);
+
+  template <typename Arg, typename... Args>
+  static void encode(Commandformat& w, const Arg& arg, const Args&... args)
+  {
+    Field::encode(w, arg);
+    Layout<Rest...>::encode(w, args...);
+  }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Reply decoders
+// ---------------------------------------------------------------------------------------------
+
+struct NoReply
+{
+};
+
+/// One data word converted to the caller's enum or integer type
+template <size_t Index>
+struct WordReply
+{
+  template <typename T>
+  static void decode(const Responseformat& r, T& value)
+  {
+    value = static_cast<T>(r.data[Index]);
+  }
+};
+
+/// Whether one data word equals \p Value
+template <size_t Index, uint16_t Value>
+struct EqualsReply
+{
+  static void decode(const Responseformat& r, bool& value)
+  {
+    value = r.data[Index] == Value;
+  }
+};
+
+/// \p Count int32 values in thousandths, starting after the length word
+template <size_t Count>
+struct MilliReply
+{
+  static void decode(const Responseformat& r, double* values)
+  {
+    for (size_t i = 0; i < Count; i++)
+    {
+      values[i] = readInt32(r, 1 + 2 * i) / 1000.0;
+    }
+  }
+};
+
+/// \p Count int32 millidegrees, returned in radians
+template <size_t Count>
+struct MilliDegreesReply
+{
+  static void decode(const Responseformat& r, double* radians)
+  {
+    int32_t millidegrees[Count];
+    std::memcpy(millidegrees, &r.data[1], sizeof(millidegrees));
+    fromMilliDegrees(millidegrees, radians, Count);
+  }
+};
+
+/// Active errors, oldest first
+struct ErrorListReply
+{
+  static void decode(const Responseformat& r, ErrorList& errors)
+  {
+    size_t count = r.data[0] >> 2;
+    errors.count = count < ErrorList::CAPACITY ? count : ErrorList::CAPACITY;
+    for (size_t i = 0; i < errors.count; i++)
+    {
+      errors.codes[i] = ((r.data[i * 4 + 4] & 0x00FF) << 16) | r.data[i * 4 + 3];
+    }
+  }
+
+  static void decode(const Responseformat& r, std::vector<std::string>& error_list)
+  {
+    ErrorList errors;
+    decode(r, errors);
+
+    error_list.clear();
+    for (size_t i = 0; i < errors.count; i++)
+    {
+      error_list.push_back(formatErrorCode(errors.codes[i]));
+    }
+  }
+};
+
+/// Length word followed by one character per word
+struct StringReply
+{
+  static void decode(const Responseformat& r, std::string& str)
+  {
+    uint16_t str_length = r.data[1];
+    str = "";
+    for (size_t i = 0; i < str_length; i++)
+    {
+      str += r.data[i + 2];
+    }
+  }
+};
+
+struct HrssVersionReply
+{
+  static void decode(const Responseformat& r, std::string& str)
+  {
+    std::stringstream ss;
+    ss << r.data[2] << "." << r.data[3] << "." << static_cast<char>(r.data[4]) << "_" << r.data[5];
+
+    str = ss.str();
+  }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Commands
+// ---------------------------------------------------------------------------------------------
+
+/*!
+ * \brief Describes one command: its id, parameter layout and, for queries, how to decode the reply.
+ */
+template <CommandId Id, typename Params = Layout<>, typename ReplyDecoder = NoReply>
+struct Command
+{
+  static constexpr CommandId ID = Id;
+  typedef ReplyDecoder Reply;
+
+  static_assert(Params::WORDS <= COMMAND_PARAM_WORDS, "Command parameters do not fit into a frame");
+
+  template <typename... Args>
+  static void encode(Commandformat& w, const Args&... args)
+  {
+    w.cmd_id = static_cast<uint16_t>(Id);
+    Params::encode(w, args...);
+    std::memset(&w.param[Params::WORDS], 0, (COMMAND_PARAM_WORDS - Params::WORDS) * sizeof(uint16_t));
+  }
+};
+
+typedef Command<CommandId::GetPermissions, Layout<Fixed<0, 0>>> GetPermissions;
+typedef Command<CommandId::SetLogLevel, Layout<Word<0>>> SetLogLevel;
+typedef Command<CommandId::SetServoAmp, Layout<Word<0>>> SetServoAmp;
+typedef Command<CommandId::GetServoAmp, Layout<>, WordReply<1>> GetServoAmp;
+typedef Command<CommandId::GetActualRPM, Layout<>, MilliReply<6>> GetActualRPM;
+typedef Command<CommandId::GetActualCurrent, Layout<>, MilliReply<6>> GetActualCurrent;
+typedef Command<CommandId::GetExtActualRPM, Layout<>, MilliReply<3>> GetExtActualRPM;
+typedef Command<CommandId::GetExtActualPosition, Layout<>, MilliDegreesReply<3>> GetExtActualPosition;
+typedef Command<CommandId::GetActualPosition,
+                Layout<Fixed<0, static_cast<uint16_t>(SpaceOperationTypes::Joint)>>, MilliDegreesReply<6>>
+    GetActualPosition;
+typedef Command<CommandId::GetMotionState, Layout<>, WordReply<1>> GetMotionState;
+typedef Command<CommandId::GetErrorCode, Layout<>, ErrorListReply> GetErrorCode;
+typedef Command<CommandId::GetHrssMode, Layout<>, EqualsReply<1, 3>> GetHrssMode;
+
+// Smooth is always on between points
+typedef Command<CommandId::PtpJoint, Layout<Fixed<0, 1>, AsciiDegrees<1, 6>>> PtpJoint;
+typedef Command<CommandId::ExtPtpJoint, Layout<Fixed<0, 1>, AsciiDegrees<1, 9>>> ExtPtpJoint;
+typedef Command<CommandId::PtpJointWithVelocity,
+                Layout<Milli<0>, Milli<2>, Fixed<4, 1>, MilliDegrees<5, 6>>>
+    PtpJointWithVelocity;
+typedef Command<CommandId::LinearSplinePoint, Layout<MilliDegrees<0, 9>, Milli<18>>> LinearSplinePoint;
+typedef Command<CommandId::CubicSplinePoint,
+                Layout<MilliDegrees<0, 9>, MilliDegrees<18, 9>, Milli<36>>>
+    CubicSplinePoint;
+typedef Command<CommandId::QuinticSplinePoint,
+                Layout<MilliDegrees<0, 9>, MilliDegrees<18, 9>, MilliDegrees<36, 9>, Milli<54>>>
+    QuinticSplinePoint;
+typedef Command<CommandId::MotionAbort> MotionAbort;
+typedef Command<CommandId::ControllerReset> ControllerReset;
+
+typedef Command<CommandId::SetPtpSpeed, Layout<Word<0>>> SetPtpSpeed;
+typedef Command<CommandId::GetPtpSpeed, Layout<>, WordReply<1>> GetPtpSpeed;
+typedef Command<CommandId::SetOverRideRatio, Layout<Word<0>>> SetOverRideRatio;
+typedef Command<CommandId::GetOverRideRatio, Layout<>, WordReply<1>> GetOverRideRatio;
+typedef Command<CommandId::SetRobotMode, Layout<Word<0>>> SetRobotMode;
+typedef Command<CommandId::GetRobotMode, Layout<>, WordReply<1>> GetRobotMode;
+typedef Command<CommandId::GetRobotVersion, Layout<>, StringReply> GetRobotVersion;
+typedef Command<CommandId::GetHRSSVersion, Layout<>, HrssVersionReply> GetHRSSVersion;
+
+}  // namespace protocol
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_PROTOCOL_HPP_
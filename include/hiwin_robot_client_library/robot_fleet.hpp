@@ -0,0 +1,111 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_ROBOT_FLEET_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_ROBOT_FLEET_HPP_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <hiwin_robot_client_library/hiwin_driver.hpp>
+#include <hiwin_robot_client_library/socket/reactor.hpp>
+
+namespace hrsdk
+{
+/*!
+ * \brief Drives many controllers from a fixed pool of reactor threads.
+ *
+ * Robots are spread round-robin over the reactors, so the thread count stays the same however
+ * many robots are added. Add all robots before connecting; the fleet itself is not thread safe,
+ * the drivers it hands out are.
+ */
+class RobotFleet
+{
+private:
+  struct Member
+  {
+    std::unique_ptr<HIWINDriver> driver;
+    int command_port;
+    int event_port;
+    int file_port;
+  };
+
+  // Declared first so the robots are gone before their reactors stop
+  std::vector<std::unique_ptr<socket::Reactor>> reactors_;
+  std::vector<Member> robots_;
+
+public:
+  static const size_t DEFAULT_REACTOR_THREADS = 2;
+
+  /*!
+   * \param busy_poll Passed on to every reactor, see socket::Reactor
+   */
+  explicit RobotFleet(size_t reactor_threads = DEFAULT_REACTOR_THREADS, bool busy_poll = false);
+  ~RobotFleet();
+
+  /*!
+   * \return Index of the new robot, used by every other call
+   */
+  size_t addRobot(const std::string& robot_ip, int command_port = COMMAND_PORT, int event_port = EVENT_PORT,
+                  int file_port = FILE_PORT);
+
+  size_t size() const;
+  size_t reactorCount() const;
+  HIWINDriver& robot(size_t index);
+
+  /*!
+   * \brief Connects every robot, with the sockets of all robots dialled in parallel.
+   *
+   * \param timeout How long all connects together may take
+   *
+   * \return Number of robots that connected and came up
+   */
+  size_t connectAll(std::chrono::milliseconds timeout = HIWINDriver::DEFAULT_CONNECT_TIMEOUT);
+  void disconnectAll();
+
+  /*!
+   * \brief Reads the state of every robot, with the requests of all robots in flight together.
+   *
+   * \p states is resized to size(), entry i belonging to robot i.
+   *
+   * \return Number of robots whose snapshot is fully valid
+   */
+  size_t readStates(std::vector<RobotStateSnapshot>& states, size_t axis_count = 6);
+
+  /*!
+   * \brief Returns the command round-trip statistics of every robot, indexed like readStates().
+   */
+  void getLatencyStats(std::vector<LatencyStats>& stats);
+};
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_ROBOT_FLEET_HPP_
@@ -0,0 +1,127 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_SEQLOCK_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_SEQLOCK_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace hrsdk
+{
+/*!
+ * \brief Single-slot value published by one writer and read without locks by any number of readers.
+ *
+ * The sequence counter is odd while a write is in progress. Readers copy the value and check
+ * that the counter did not change underneath them, so they never block the writer and never see
+ * a torn value. There must be only one writer at a time; stores from several threads have to be
+ * serialised by the caller.
+ */
+template <typename T>
+class SeqLock
+{
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+private:
+  std::atomic<uint64_t> seq_;
+  T value_;
+
+public:
+  SeqLock() : seq_(0), value_()
+  {
+  }
+
+  void store(const T& value)
+  {
+    const uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&value_, &value, sizeof(T));
+
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  /*!
+   * \brief Makes one attempt at copying the latest value into \p value.
+   *
+   * Gives up instead of waiting if a store is in progress, so a real-time reader can never be held
+   * up by a preempted writer.
+   *
+   * \return false, leaving \p value and \p version untouched, if a store got in the way. Otherwise
+   *         \p version is the number of stores made so far, 0 if nothing has been published yet.
+   */
+  bool tryLoad(T& value, uint64_t& version) const
+  {
+    const uint64_t before = seq_.load(std::memory_order_acquire);
+    if (before & 1)
+    {
+      return false;
+    }
+
+    T copy;
+    std::memcpy(&copy, &value_, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != before)
+    {
+      return false;
+    }
+
+    value = copy;
+    version = before >> 1;
+    return true;
+  }
+
+  /*!
+   * \brief Copies the latest value into \p value, retrying for as long as stores get in the way.
+   *
+   * Spins while the writer is in the middle of a store; readers that must not wait on the writer
+   * use tryLoad().
+   *
+   * \return Number of stores made so far, 0 if nothing has been published yet
+   */
+  uint64_t load(T& value) const
+  {
+    uint64_t version;
+    while (!tryLoad(value, version))
+    {
+    }
+    return version;
+  }
+
+  uint64_t version() const
+  {
+    return seq_.load(std::memory_order_acquire) >> 1;
+  }
+};
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_SEQLOCK_HPP_
@@ -0,0 +1,98 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_SOCKET_REACTOR_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_SOCKET_REACTOR_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <hiwin_robot_client_library/socket/tcp_client.hpp>
+
+namespace hrsdk
+{
+namespace socket
+{
+
+/*!
+ * \brief Single epoll thread servicing the receive side of any number of TCPClients.
+ *
+ * Registered clients have TCPClient::onReadable() called from the reactor thread whenever their
+ * socket has data. Writes stay on the calling threads.
+ */
+class Reactor
+{
+private:
+  int epoll_fd_;
+  int wake_fd_;
+  bool busy_poll_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+
+  // Held by the reactor thread while it calls into clients, so remove() can wait for it
+  std::recursive_mutex dispatch_mutex_;
+
+  // Registered clients by the token their epoll events carry. Guarded by dispatch_mutex_; an event
+  // whose token is gone belongs to a removed client and is dropped. Token 0 is the wake-up event.
+  std::map<uint64_t, TCPClient*> clients_;
+  uint64_t next_token_;
+
+  void run();
+
+public:
+  static const int MAX_EVENTS = 64;
+
+  /*!
+   * \param busy_poll Spin on epoll_wait() instead of sleeping in it. Trades a fully used core for
+   *                  lower wake-up latency.
+   */
+  explicit Reactor(bool busy_poll = false);
+  ~Reactor();
+
+  bool start();
+  void stop();
+  bool isRunning() const;
+
+  /*!
+   * \brief Starts delivering read events of \p client, which must be connected.
+   */
+  bool add(TCPClient* client);
+
+  /*!
+   * \brief Stops delivering events to \p client. Once this returns the reactor will not call into it again.
+   */
+  void remove(TCPClient* client);
+};
+
+}  // namespace socket
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_SOCKET_REACTOR_HPP_
@@ -31,6 +31,7 @@
 #include <mutex>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace hrsdk
 {
@@ -40,6 +41,7 @@ namespace socket
 enum class SocketState
 {
   Invalid,       ///< Socket is initialized or setup failed
+  Connecting,    ///< Non-blocking connect started by beginConnect() is in progress
   Connected,     ///< Socket is connected and ready to use
   Disconnected,  ///< Socket is disconnected and cannot be used
   Closed         ///< Connection to socket got closed
@@ -52,7 +54,18 @@ private:
   std::atomic<SocketState> state_;
   std::chrono::milliseconds reconnection_time_;
 
+  // Per-connection receive buffer used to reassemble fixed-size frames.
+  // Bytes in [recv_begin_, recv_end_) have been received but not yet consumed.
+  std::vector<uint8_t> recv_buffer_;
+  size_t recv_begin_;
+  size_t recv_end_;
+
   void setupOptions();
+  bool finishConnect();
+
+  // Appends what one recv() delivers to the receive buffer. Returns the number of bytes added,
+  // 0 if nothing was available (timeout or MSG_DONTWAIT) and -1 once the connection is gone.
+  ssize_t fillReceiveBuffer(int flags);
 
 protected:
   static bool open(int socket_fd, struct sockaddr* address, size_t address_len)
@@ -65,6 +78,34 @@ protected:
 
   std::unique_ptr<timeval> recv_timeout_;
 
+  /*!
+   * \brief Moves everything the socket has ready into the receive buffer without blocking.
+   *
+   * \return false if the connection is gone
+   */
+  bool receiveAvailable();
+
+  /*!
+   * \brief Takes one complete frame out of the receive buffer without touching the socket.
+   *
+   * \return false if fewer than \p frame_len bytes are buffered
+   */
+  bool takeFrame(uint8_t* buf, const size_t frame_len);
+
+  size_t receiveBuffered() const;
+
+  /*!
+   * \brief Drops everything in the receive buffer.
+   */
+  void resetReceiveBuffer();
+
+  /*!
+   * \brief Called once a connection is up. Subclasses start their receive side here.
+   *
+   * \return false to reject the connection
+   */
+  virtual bool onConnected();
+
 public:
   static constexpr std::chrono::milliseconds DEFAULT_RECONNECTION_TIME{ 10000 };
 
@@ -76,13 +117,62 @@ public:
     return state_;
   }
 
+  int getSocketFd() const
+  {
+    return socket_fd_;
+  }
+
+  /*!
+   * \brief Called by a Reactor whenever the socket has data to read.
+   *
+   * The default implementation only buffers the data for later read() or readFrame() calls.
+   */
+  virtual void onReadable();
+
+  static constexpr size_t RECEIVE_BUFFER_SIZE = 8192;
+
   bool read(uint8_t* buf, const size_t buf_len, size_t& read);
 
+  /*!
+   * \brief Reads exactly \p frame_len bytes, reassembling the frame from as many recv() calls as needed.
+   *
+   * Bytes received beyond the requested frame stay buffered for the next call. If the read fails
+   * (timeout, disconnect) any partial frame is kept, so the stream does not lose its alignment.
+   */
+  bool readFrame(uint8_t* buf, const size_t frame_len);
+
+  /*!
+   * \brief Pushes bytes back in front of the receive buffer, e.g. to resynchronise after a bad frame.
+   */
+  void unread(const uint8_t* buf, const size_t len);
+
   bool write(const uint8_t* buf, const size_t buf_len, size_t& written);
 
   void close();
 
+  /*!
+   * \brief Shuts both directions of the connection down, waking up any thread blocked in recv().
+   */
+  void shutdown();
+
   void setReceiveTimeout(const timeval& timeout);
+
+  /*!
+   * \brief Starts a non-blocking connect and returns straight away. Finish it with connectAll().
+   *
+   * \return false if the connect failed immediately
+   */
+  bool beginConnect(const std::string& ip_addr, const int port);
+
+  /*!
+   * \brief Completes the connects started with beginConnect(), waiting at most \p timeout for all of them.
+   *
+   * The handshakes run in parallel, so this takes as long as the slowest one rather than their
+   * sum. Clients that did not connect in time are closed and left in SocketState::Invalid.
+   *
+   * \return true if every client is connected
+   */
+  static bool connectAll(TCPClient* const* clients, size_t count, std::chrono::milliseconds timeout);
 };
 
 }  // namespace socket
@@ -0,0 +1,64 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TIME_PARAMETERIZATION_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TIME_PARAMETERIZATION_HPP_
+
+#include "hiwin_robot_client_library/trajectory.hpp"
+
+namespace hrsdk
+{
+/// Shortest goal_time parameterizeTrajectory() gives a segment [s]
+static const double MIN_SEGMENT_TIME = 0.001;
+
+/*!
+ * \brief Times a joint-space path for the quintic spline command, as fast as the limits allow.
+ *
+ * \p path holds the waypoints in its positions, the rest of it is ignored. The robot is taken to
+ * stand still at the first waypoint. \p trajectory receives all the others with the velocities,
+ * accelerations and goal times that keep every quintic segment between them within the velocity,
+ * acceleration and jerk limits, ready for writeTrajectory() with TrajectoryType::Quintic.
+ *
+ * The path speed is run along the waypoints as fast as the limits allow, braking in time for the
+ * end and changing its acceleration at bounded jerk, and the waypoint states follow from it.
+ * Segments whose quintic still peaks above a limit cap the speed there for another run. The run
+ * that is shortest once stretched as a whole to fit every limit is returned; stretching the
+ * whole trajectory keeps it smooth, which stretching single segments would not.
+ *
+ * The goal times are whole milliseconds, as the controller runs them. Rounding each segment up
+ * unevenly disturbs the smooth timing, most on dense paths whose segments last only a few
+ * milliseconds, so the limits are checked on the rounded times and the stretch is grown until
+ * they hold there. Should that not converge, the trajectory stops at every waypoint instead.
+ *
+ * \return false if the path has fewer than two waypoints or does not match the limits' axes
+ */
+bool parameterizeTrajectory(const TrajectoryBuffer& path, const JointLimits& limits, TrajectoryBuffer& trajectory);
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TIME_PARAMETERIZATION_HPP_
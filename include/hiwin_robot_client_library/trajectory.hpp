@@ -0,0 +1,178 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_HPP_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "hiwin_robot_client_library/protocol.hpp"
+
+namespace hrsdk
+{
+/// Axes a spline point command carries: six arm joints and three external axes
+static const size_t TRAJECTORY_MAX_AXES = 9;
+
+/// Memory a TrajectoryCache may use unless told otherwise
+static const size_t DEFAULT_TRAJECTORY_CACHE_BYTES = 64 * 1024 * 1024;
+
+enum class TrajectoryType
+{
+  Linear,   ///< Positions only, see Commander::linearSplinePoint
+  Cubic,    ///< Positions and velocities, see Commander::CubicSplinePoint
+  Quintic,  ///< Positions, velocities and accelerations, see Commander::QuintSplinePoint
+};
+
+/// One point of a trajectory; axes that are not used must be zero
+struct TrajectoryPoint
+{
+  double positions[TRAJECTORY_MAX_AXES];      // [rad]
+  double velocities[TRAJECTORY_MAX_AXES];     // [rad/s], used by cubic and quintic trajectories
+  double accelerations[TRAJECTORY_MAX_AXES];  // [rad/s^2], used by quintic trajectories
+  double goal_time;                           // [s] to get here from the previous point
+};
+
+/*!
+ * \brief A trajectory in structure-of-arrays layout, for the stages that work on whole trajectories.
+ *
+ * Every quantity of every axis is one contiguous array over the points, so loops over the points
+ * of an axis vectorize. Each array, goal_times included, holds one entry per point.
+ */
+struct TrajectoryBuffer
+{
+  size_t axis_count;
+  std::vector<double> positions[TRAJECTORY_MAX_AXES];
+  std::vector<double> velocities[TRAJECTORY_MAX_AXES];
+  std::vector<double> accelerations[TRAJECTORY_MAX_AXES];
+  std::vector<double> goal_times;
+
+  TrajectoryBuffer();
+
+  size_t size() const
+  {
+    return goal_times.size();
+  }
+
+  /// Resizes every array of the first \p axis_count axes to \p points entries, new ones zero
+  void resize(size_t axis_count, size_t points);
+
+  void fromPoints(const std::vector<TrajectoryPoint>& points, size_t axis_count);
+  void toPoints(std::vector<TrajectoryPoint>& points) const;
+};
+
+/// Kinematic limits of each axis of a robot; velocity, acceleration and jerk limits must be positive
+struct JointLimits
+{
+  size_t axis_count;
+  double min_position[TRAJECTORY_MAX_AXES];      // [rad], no position limit if equal to max_position
+  double max_position[TRAJECTORY_MAX_AXES];      // [rad]
+  double max_velocity[TRAJECTORY_MAX_AXES];      // [rad/s]
+  double max_acceleration[TRAJECTORY_MAX_AXES];  // [rad/s^2]
+  double max_jerk[TRAJECTORY_MAX_AXES];          // [rad/s^3]
+};
+
+/// Encodes \p point as the spline point command of \p type
+void encodeTrajectoryPoint(Commandformat& w, const TrajectoryPoint& point, TrajectoryType type, double goal_time);
+
+/*!
+ * \brief A trajectory encoded once into ready-to-send command frames.
+ *
+ * The frames are contiguous, so replaying them is a matter of writing the buffer.
+ */
+struct CompiledTrajectory
+{
+  TrajectoryType type;
+  uint64_t hash;
+  std::vector<TrajectoryPoint> points;  // Source of the frames, one per point
+  std::vector<Commandformat> frames;
+
+  static std::shared_ptr<const CompiledTrajectory> compile(const std::vector<TrajectoryPoint>& points,
+                                                           TrajectoryType type);
+
+  /// Content hash of a trajectory, as stored in \p hash
+  static uint64_t hashOf(const std::vector<TrajectoryPoint>& points, TrajectoryType type);
+
+  /// Memory held by this trajectory
+  size_t bytes() const;
+};
+
+struct TrajectoryCacheStats
+{
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t entries;
+  size_t bytes;
+};
+
+/*!
+ * \brief Keeps the compiled form of recently used trajectories, keyed by their content.
+ *
+ * Once the cache holds more than its memory cap, the least recently used trajectories are
+ * dropped. Trajectories handed out stay valid after eviction for as long as they are referenced.
+ * Lookups compare the whole trajectory, not just its hash. Thread safe.
+ */
+class TrajectoryCache
+{
+private:
+  typedef std::list<std::shared_ptr<const CompiledTrajectory>> LruList;
+
+  mutable std::mutex mutex_;
+  LruList lru_;  // Most recently used first
+  std::unordered_multimap<uint64_t, LruList::iterator> index_;
+  size_t max_bytes_;
+  TrajectoryCacheStats stats_;
+
+  // Looks a trajectory up and marks it most recently used; null if it is not cached. Needs mutex_.
+  std::shared_ptr<const CompiledTrajectory> find(uint64_t hash, const std::vector<TrajectoryPoint>& points,
+                                                 TrajectoryType type);
+  void evict();
+
+public:
+  explicit TrajectoryCache(size_t max_bytes = DEFAULT_TRAJECTORY_CACHE_BYTES);
+
+  /*!
+   * \brief Returns the compiled form of \p points, compiling it on a miss.
+   *
+   * A trajectory larger than the cap is compiled but not kept.
+   */
+  std::shared_ptr<const CompiledTrajectory> get(const std::vector<TrajectoryPoint>& points, TrajectoryType type);
+
+  void setMaxBytes(size_t max_bytes);
+  void clear();
+  TrajectoryCacheStats getStats() const;
+};
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_HPP_
@@ -0,0 +1,72 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_VALIDATION_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_VALIDATION_HPP_
+
+#include "hiwin_robot_client_library/trajectory.hpp"
+
+namespace hrsdk
+{
+enum class LimitViolation
+{
+  None = 0,
+  Position,          ///< Position outside [min_position, max_position]
+  Velocity,          ///< |velocity| above max_velocity
+  Acceleration,      ///< |acceleration| above max_acceleration
+  PositionStep,      ///< Position moved further than max_velocity allows in the goal time
+  VelocityStep,      ///< Velocity changed more than max_acceleration allows in the goal time
+  AccelerationStep,  ///< Acceleration changed more than max_jerk allows in the goal time
+};
+
+/// First limit a trajectory breaks, see validateTrajectory
+struct TrajectoryViolation
+{
+  LimitViolation violation;
+  size_t index;  // Point that breaks it, the point count if none does
+  size_t axis;
+};
+
+/*!
+ * \brief Checks a whole trajectory against \p limits before any of it is sent.
+ *
+ * Every point must lie within the position limits and, as far as \p type sends them, the velocity
+ * and acceleration limits. Each point must also be reachable from the one before in its goal
+ * time: its position, velocity and acceleration may not change faster than the velocity,
+ * acceleration and jerk limits allow. The first point is not compared with where the robot is.
+ * Values that are not numbers break every limit. The axes are checked two points at a time with
+ * SSE2 where available.
+ *
+ * \return false, with the lowest offending index and its axis in \p violation, if a limit is broken
+ */
+bool validateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const JointLimits& limits,
+                        TrajectoryViolation& violation);
+
+}  // namespace hrsdk
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TRAJECTORY_VALIDATION_HPP_
@@ -27,82 +27,75 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
-#include <sstream>
-#include <iomanip>
 #include <vector>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 #include <hiwin_robot_client_library/commander.hpp>
 
 namespace hrsdk
 {
 
-enum class SpaceOperationTypes
-{
-  Cartesian = 0,
-  Joint,
-  Tool,
-};
-
-enum class CommandType
-{
-  Get = 0,
-  Set,
-  MonitorSet,
-};
-
-enum class CommandId : uint16_t
-{
-  GetPermissions = 0x000A,
-  SetPtpSpeed = 0x0096,
-  GetPtpSpeed = 0x0098,
-  SetOverRideRatio = 0x012C,
-  GetOverRideRatio = 0x012D,
-  SetServoAmp = 0x0578,
-  GetServoAmp = 0x0579,
-  GetRobotVersion = 0x057A,
-  SetRobotMode = 0x058C,
-  GetRobotMode = 0x058D,
-  ControllerReset = 0x05AA,
-  PtpJoint = 0x07D2,
-  PtpJointWithVelocity = 0x07D6,
-  LinearSplinePoint = 0x07E8,
-  CubicSplinePoint = 0x07E9,
-  QuinticSplinePoint = 0x07EA,
-  ExtPtpJoint = 0x07EF,
-  MotionAbort = 0x07FA,
-  GetExtActualRPM = 0x0863,
-  GetExtActualPosition = 0x0864,
-  GetActualPosition = 0x0866,
-  GetActualRPM = 0x0867,
-  GetErrorCode = 0x086C,
-  GetMotionState = 0x086D,
-  SetLogLevel = 0x1003,
-  GetActualCurrent = 0x100A,
-  GetHRSSVersion = 0x100B,
-  GetHrssMode = 0x1036,
-};
-
-struct Commandformat
-{
-  uint16_t cmd_id;
-  uint16_t param[249];
-} __attribute__((__packed__));
-
-struct Responseformat
-{
-  uint16_t cmd_id;
-  uint16_t result;
-  uint16_t data[248];
-} __attribute__((__packed__));
-
-Commander::Commander(const std::string& robot_ip, const int port) : robot_ip_(robot_ip), port_(port)
+static bool isKnownCommand(uint16_t cmd_id)
+{
+  switch (static_cast<CommandId>(cmd_id))
+  {
+    case CommandId::GetPermissions:
+    case CommandId::SetPtpSpeed:
+    case CommandId::GetPtpSpeed:
+    case CommandId::SetOverRideRatio:
+    case CommandId::GetOverRideRatio:
+    case CommandId::SetServoAmp:
+    case CommandId::GetServoAmp:
+    case CommandId::GetRobotVersion:
+    case CommandId::SetRobotMode:
+    case CommandId::GetRobotMode:
+    case CommandId::ControllerReset:
+    case CommandId::PtpJoint:
+    case CommandId::PtpJointWithVelocity:
+    case CommandId::LinearSplinePoint:
+    case CommandId::CubicSplinePoint:
+    case CommandId::QuinticSplinePoint:
+    case CommandId::ExtPtpJoint:
+    case CommandId::MotionAbort:
+    case CommandId::GetExtActualRPM:
+    case CommandId::GetExtActualPosition:
+    case CommandId::GetActualPosition:
+    case CommandId::GetActualRPM:
+    case CommandId::GetErrorCode:
+    case CommandId::GetMotionState:
+    case CommandId::SetLogLevel:
+    case CommandId::GetActualCurrent:
+    case CommandId::GetHRSSVersion:
+    case CommandId::GetHrssMode:
+      return true;
+  }
+  return false;
+}
+
+constexpr size_t Commander::DEFAULT_PIPELINE_DEPTH;
+
+// Handed to response handlers whose request failed before a response arrived
+static const Responseformat EMPTY_RESPONSE = {};
+
+Commander::Commander(const std::string& robot_ip, const int port)
+  : robot_ip_(robot_ip)
+  , port_(port)
+  , pipeline_depth_(DEFAULT_PIPELINE_DEPTH)
+  , receiving_(false)
+  , latency_()
+  , latency_total_ns_(0)
+  , priority_waiting_(0)
+  , reactor_(nullptr)
 {
 }
 
 Commander::~Commander()
 {
+  disconnect();
 }
 
 bool Commander::connect()
@@ -118,756 +111,844 @@ bool Commander::connect()
     return false;
   }
 
+  if (!onConnected())
+  {
+    TCPClient::close();
+    return false;
+  }
   return true;
 }
 
-bool Commander::isRemoteMode()
+bool Commander::onConnected()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetHrssMode);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  if (receiver_thread_.joinable())
+  {
+    receiver_thread_.join();
+  }
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
   {
-    return false;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    receiving_ = true;
   }
+  resetLatencyStats();
 
-  uint16_t data_length = r.data[0];
-  if (r.data[1] != 3)
+  if (reactor_ != nullptr)
   {
-    return false;
+    if (!reactor_->add(this))
+    {
+      failPending();
+      return false;
+    }
+    return true;
   }
 
+  receiver_thread_ = std::thread(&Commander::receiveLoop, this);
   return true;
 }
 
-int Commander::getPermissions()
+void Commander::disconnect()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetPermissions);
-  w.param[0] = 0;
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+  // Wakes the receiver from recv(); it fails whatever is still pending on its way out
+  TCPClient::shutdown();
+  if (receiver_thread_.joinable())
+  {
+    receiver_thread_.join();
+  }
+  if (reactor_ != nullptr && getSocketFd() >= 0)
+  {
+    reactor_->remove(this);
+    failPending();
+  }
+  TCPClient::close();
 }
 
-int Commander::setLogLevel(LogLevels level)
+void Commander::setReactor(socket::Reactor* reactor)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::SetLogLevel);
-  w.param[0] = static_cast<uint16_t>(level);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+  reactor_ = reactor;
 }
 
-int Commander::setServoAmpState(bool enable)
+void Commander::onReadable()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::SetServoAmp);
-  w.param[0] = static_cast<uint16_t>(enable);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  bool connected = TCPClient::receiveAvailable();
 
-  size_t read_chars;
-  Responseformat r = {};
+  Responseformat r;
   uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  while (TCPClient::takeFrame(data_r, sizeof(Responseformat)))
+  {
+    dispatch(r);
+  }
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+  if (!connected)
+  {
+    failPending();
+  }
 }
 
-int Commander::getServoAmpState(bool& enable)
+size_t Commander::submit(const Commandformat* w, const ResponseHandler* handlers, size_t count, bool priority)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  if (priority)
+  {
+    priority_waiting_++;
+  }
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetServoAmp);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  size_t sent = 0;
+  size_t handled = 0;
+  while (handled < count)
+  {
+    if (!priority)
+    {
+      // Wait for room in the pipeline and for priority frames to go first, without holding the socket
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      window_cv_.wait(lock, [this] {
+        return (pending_.size() < pipeline_depth_ && priority_waiting_ == 0) || !receiving_;
+      });
+    }
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+    std::lock_guard<std::mutex> write_lock(write_mutex_);
+    size_t window;
+    {
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      if (!receiving_)
+      {
+        break;
+      }
+
+      // Priority frames go out whatever the pipeline holds. Other frames get the room left, which
+      // another writer may have taken since the wait above, and hand the socket to a priority frame
+      // that arrived in the meantime.
+      window = count - handled;
+      if (!priority)
+      {
+        window = std::min(window, pipeline_depth_ - std::min(pending_.size(), pipeline_depth_));
+        if (window == 0 || priority_waiting_ > 0)
+        {
+          continue;
+        }
+      }
+
+      // Queue the entries before writing, the response may arrive before write() returns
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < window; i++)
+      {
+        pending_.push_back(PendingRequest{ w[handled + i].cmd_id, handlers[handled + i], now });
+      }
+    }
+
+    size_t written;
+    const bool ok = writeQueued(&w[handled], &handlers[handled], window, written);
+    sent += written;
+    handled += window;
+    if (!ok)
+    {
+      break;
+    }
+  }
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  if (priority && --priority_waiting_ == 0)
   {
-    return r.result;
+    // Taking the mutex orders the wake-up after any writer that saw the count still up and is
+    // about to wait
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    window_cv_.notify_all();
   }
 
-  uint16_t data_length = r.data[0];
-  enable = (r.data[1] > 0) ? true : false;
-  return r.result;
+  for (size_t i = handled; i < count; i++)
+  {
+    handlers[i](COMMUNICATION_ERROR, EMPTY_RESPONSE);
+  }
+  return sent;
 }
 
-int Commander::getActualRPM(double (&velocities)[6])
+bool Commander::trySubmit(const Commandformat* w, const ResponseHandler* handlers, size_t count)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetActualRPM);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  std::unique_lock<std::mutex> write_lock(write_mutex_, std::try_to_lock);
+  if (!write_lock.owns_lock())
+  {
+    return false;
+  }
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  std::unique_lock<std::mutex> lock(pending_mutex_);
+  if (receiving_ && (priority_waiting_ > 0 || pending_.size() + count > pipeline_depth_))
+  {
+    return false;
+  }
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  // A closed connection takes the frames and fails them, like submit()
+  if (!receiving_)
   {
-    return r.result;
+    lock.unlock();
+    for (size_t i = 0; i < count; i++)
+    {
+      handlers[i](COMMUNICATION_ERROR, EMPTY_RESPONSE);
+    }
+    return true;
   }
 
-  uint16_t data_length = r.data[0];
-  int32_t value;
-  for (size_t i = 0; i < 6; i++)
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i++)
   {
-    memcpy(&value, ((data_r + 6) + (i * 4)), sizeof(int32_t));
-    velocities[i] = value / 1000.0;
+    pending_.push_back(PendingRequest{ w[i].cmd_id, handlers[i], now });
   }
-  return r.result;
+  lock.unlock();
+
+  size_t written;
+  writeQueued(w, handlers, count, written);
+  return true;
 }
 
-int Commander::getActualCurrent(double (&efforts)[6])
+bool Commander::writeQueued(const Commandformat* w, const ResponseHandler* handlers, size_t count, size_t& sent)
 {
   size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetActualCurrent);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<const void*>(w));
+  if (!TCPClient::write(data_w, count * sizeof(Commandformat), written))
+  {
+    // Nobody else appends while write_mutex_ is held, so whatever the receiver has not
+    // completed yet is still at the back of the queue
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    size_t queued = std::min(count, pending_.size());
+    pending_.erase(pending_.end() - queued, pending_.end());
+    lock.unlock();
+    window_cv_.notify_all();
+
+    for (size_t i = count - queued; i < count; i++)
+    {
+      handlers[i](COMMUNICATION_ERROR, EMPTY_RESPONSE);
+    }
+    sent = count - queued;
+    return false;
+  }
+  sent = count;
+  return true;
+}
 
-  size_t read_chars;
-  Responseformat r = {};
+void Commander::receiveLoop()
+{
+  Responseformat r;
   uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  while (true)
   {
-    return r.result;
+    if (!TCPClient::readFrame(data_r, sizeof(Responseformat)))
+    {
+      // A receive timeout keeps the partial frame buffered; anything else ends the connection
+      if (getState() == socket::SocketState::Connected)
+      {
+        continue;
+      }
+      break;
+    }
+    dispatch(r);
   }
 
-  uint16_t data_length = r.data[0];
-  int32_t value;
-  for (size_t i = 0; i < 6; i++)
-  {
-    memcpy(&value, ((data_r + 6) + (i * 4)), sizeof(int32_t));
-    efforts[i] = value / 1000.0;
-  }
-  return r.result;
+  failPending();
 }
 
-int Commander::getExtActualRPM(double (&velocities)[3])
+void Commander::dispatch(const Responseformat& r)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetExtActualRPM);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  std::unique_lock<std::mutex> lock(pending_mutex_);
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  size_t match = 0;
+  while (match < pending_.size() && pending_[match].cmd_id != r.cmd_id)
+  {
+    match++;
+  }
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  if (match == pending_.size())
   {
-    return r.result;
+    bool expecting = !pending_.empty();
+    uint16_t cmd_id = expecting ? pending_.front().cmd_id : 0;
+    lock.unlock();
+
+    if (isKnownCommand(r.cmd_id) || !expecting)
+    {
+      std::cout << "Dropping unexpected response 0x" << std::hex << r.cmd_id << std::dec << std::endl;
+      return;
+    }
+
+    // The stream lost its alignment. Skip ahead to the next place the expected id shows up and
+    // read the frame from there. The last byte is always kept as it may be the first half of the id.
+    const uint8_t* data_r = static_cast<const uint8_t*>(static_cast<const void*>(&r));
+    const uint8_t id_bytes[2] = { static_cast<uint8_t>(cmd_id & 0xFF), static_cast<uint8_t>(cmd_id >> 8) };
+    size_t offset = 1;
+    while (offset < sizeof(Responseformat) - 1 &&
+           !(data_r[offset] == id_bytes[0] && data_r[offset + 1] == id_bytes[1]))
+    {
+      offset++;
+    }
+    std::cout << "Resynchronising response stream, skipped " << offset << " bytes" << std::endl;
+    TCPClient::unread(data_r + offset, sizeof(Responseformat) - offset);
+    return;
   }
 
-  uint16_t data_length = r.data[0];
-  int32_t value;
-  for (size_t i = 0; i < 3; i++)
+  // Responses are answered in order, so requests queued ahead of the match will never get theirs
+  for (size_t i = 0; i <= match; i++)
   {
-    memcpy(&value, ((data_r + 6) + (i * 4)), sizeof(int32_t));
-    velocities[i] = value / 1000.0;
+    PendingRequest entry = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+    window_cv_.notify_all();
+
+    if (i < match)
+    {
+      std::cout << "Response to 0x" << std::hex << entry.cmd_id << " was lost" << std::dec << std::endl;
+      entry.handler(COMMUNICATION_ERROR, EMPTY_RESPONSE);
+    }
+    else
+    {
+      recordLatency(entry.sent);
+      entry.handler(r.result, r);
+    }
+    lock.lock();
   }
-  return r.result;
 }
 
-int Commander::getExtActualPosition(double (&positions)[3])
+void Commander::failPending()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetExtActualPosition);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  std::deque<PendingRequest> failed;
   {
-    return r.result;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    receiving_ = false;
+    failed.swap(pending_);
   }
+  window_cv_.notify_all();
 
-  int32_t value;
-  uint16_t data_length = r.data[0];
-  for (size_t i = 0; i < 3; i++)
+  for (size_t i = 0; i < failed.size(); i++)
   {
-    memcpy(&value, ((data_r + 6) + (i * 4)), sizeof(int32_t));
-    positions[i] = (value / 1000.0) * (M_PI / 180);
+    failed[i].handler(COMMUNICATION_ERROR, EMPTY_RESPONSE);
   }
-  return r.result;
 }
 
-int Commander::getActualPosition(double (&positions)[6])
+std::future<int> Commander::requestAsync(const Commandformat& w, const ResponseDecoder& decode, bool priority)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  std::shared_ptr<std::promise<int>> promise = std::make_shared<std::promise<int>>();
+  std::future<int> future = promise->get_future();
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetActualPosition);
-  w.param[0] = static_cast<uint16_t>(SpaceOperationTypes::Joint);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  ResponseHandler handler = [promise, decode](int result, const Responseformat& r) {
+    if (result == 0 && decode)
+    {
+      decode(r);
+    }
+    promise->set_value(result);
+  };
+  submit(&w, &handler, 1, priority);
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return future;
+}
+
+std::future<int> Commander::requestBatchAsync(const Commandformat* w, size_t count, const BatchHandler& on_response,
+                                              const std::function<int()>& finish, bool wait)
+{
+  struct Batch
+  {
+    std::promise<int> promise;
+    std::atomic<size_t> remaining;
+    BatchHandler on_response;
+    std::function<int()> finish;
+  };
+
+  std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+  batch->remaining = count;
+  batch->on_response = on_response;
+  batch->finish = finish;
+  std::future<int> future = batch->promise.get_future();
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  if (count == 0)
   {
-    return r.result;
+    batch->promise.set_value(batch->finish());
+    return future;
   }
 
-  int32_t value;
-  uint16_t data_length = r.data[0];
-  for (size_t i = 0; i < 6; i++)
+  std::vector<ResponseHandler> handlers(count);
+  for (size_t i = 0; i < count; i++)
   {
-    memcpy(&value, ((data_r + 6) + (i * 4)), sizeof(int32_t));
-    positions[i] = (value / 1000.0) * (M_PI / 180);
+    handlers[i] = [batch, i](int result, const Responseformat& r) {
+      batch->on_response(i, result, r);
+      if (--batch->remaining == 0)
+      {
+        batch->promise.set_value(batch->finish());
+      }
+    };
   }
-  return r.result;
+  if (!wait)
+  {
+    // The handlers hold the only other reference to the batch and go with it
+    return trySubmit(w, handlers.data(), count) ? std::move(future) : std::future<int>();
+  }
+  submit(w, handlers.data(), count);
+
+  return future;
 }
 
-int Commander::getMotionState(MotionStatus& status)
+template <typename Cmd, typename... Args>
+std::future<int> Commander::send(const Args&... args)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  Commandformat w;
+  Cmd::encode(w, args...);
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetMotionState);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  return requestAsync(w);
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+template <typename Cmd, typename Out>
+std::future<int> Commander::query(Out& out)
+{
+  Commandformat w;
+  Cmd::encode(w);
+
+  return requestAsync(w, [&out](const Responseformat& r) { Cmd::Reply::decode(r, out); });
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+void Commander::setPipelineDepth(size_t depth)
+{
   {
-    return r.result;
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pipeline_depth_ = std::max<size_t>(depth, 1);
   }
+  window_cv_.notify_all();
+}
 
-  uint16_t data_length = r.data[0];
-  status = static_cast<MotionStatus>(r.data[1]);
-  return r.result;
+size_t Commander::getPipelineDepth() const
+{
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  return pipeline_depth_;
 }
 
-int Commander::getErrorCode(std::vector<std::string>& error_list)
+LatencyStats Commander::getLatencyStats()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  return latency_;
+}
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetErrorCode);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+void Commander::resetLatencyStats()
+{
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  latency_ = LatencyStats();
+  latency_total_ns_ = 0;
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+void Commander::recordLatency(std::chrono::steady_clock::time_point sent)
+{
+  int64_t ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sent).count();
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  if (latency_.count == 0 || ns < latency_.min_ns)
   {
-    return r.result;
+    latency_.min_ns = ns;
   }
-
-  uint16_t data_length = r.data[0];
-  uint16_t count = data_length >> 2;
-  uint16_t first, second, thrid;
-  char buffer[12];
-  error_list.clear();
-  for (size_t i = 0; i < count; i++)
+  if (ns > latency_.max_ns)
   {
-    first = r.data[i * 4 + 4] & 0x00FF;
-    second = (r.data[i * 4 + 3] & 0xFF00) >> 8;
-    thrid = (r.data[i * 4 + 3] & 0x00FF);
-
-    sprintf(buffer, "Err%02x-%02x-%02x", first, second, thrid);
-    error_list.push_back(std::string(buffer));
+    latency_.max_ns = ns;
   }
-  return r.result;
+  latency_.count++;
+  latency_total_ns_ += ns;
+  latency_.mean_ns = latency_total_ns_ / static_cast<int64_t>(latency_.count);
+  latency_.last_ns = ns;
 }
 
-int Commander::ptpJoint(double* positions)
+bool Commander::isRemoteMode()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  bool remote_mode = false;
+  isRemoteModeAsync(remote_mode).get();
+  return remote_mode;
+}
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::PtpJoint);
+std::future<int> Commander::isRemoteModeAsync(bool& remote_mode)
+{
+  return query<protocol::GetHrssMode>(remote_mode);
+}
 
-  // Smooth on between the points
-  w.param[0] = 1;
+int Commander::getPermissions()
+{
+  return getPermissionsAsync().get();
+}
+
+std::future<int> Commander::getPermissionsAsync()
+{
+  return send<protocol::GetPermissions>();
+}
 
-  std::string pos_str = "";
-  for (size_t i = 0; i < 6; i++)
+int Commander::setLogLevel(LogLevels level)
+{
+  return setLogLevelAsync(level).get();
+}
+
+std::future<int> Commander::setLogLevelAsync(LogLevels level)
+{
+  return send<protocol::SetLogLevel>(level);
+}
+
+int Commander::setServoAmpState(bool enable)
+{
+  return setServoAmpStateAsync(enable).get();
+}
+
+std::future<int> Commander::setServoAmpStateAsync(bool enable)
+{
+  if (enable)
   {
-    if (i != 0)
-    {
-      pos_str += ",";
-    }
-    std::stringstream stream;
-    stream << std::fixed << std::setprecision(7) << (positions[i] * (180 / M_PI));
-    pos_str += stream.str();
+    return send<protocol::SetServoAmp>(enable);
   }
-  w.param[1] = pos_str.length();
-  std::copy(pos_str.begin(), pos_str.end(), &w.param[2]);
 
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+  Commandformat w;
+  protocol::SetServoAmp::encode(w, enable);
+  return requestAsync(w, ResponseDecoder(), true);
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+int Commander::getServoAmpState(bool& enable)
+{
+  return getServoAmpStateAsync(enable).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::getServoAmpStateAsync(bool& enable)
+{
+  return query<protocol::GetServoAmp>(enable);
 }
 
-int Commander::ptpJoint(double* positions, double acc_time, double ratio)
+int Commander::getActualRPM(double (&velocities)[6])
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  return getActualRPMAsync(velocities).get();
+}
+
+std::future<int> Commander::getActualRPMAsync(double (&velocities)[6])
+{
+  return query<protocol::GetActualRPM>(velocities);
+}
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::PtpJointWithVelocity);
+int Commander::getActualCurrent(double (&efforts)[6])
+{
+  return getActualCurrentAsync(efforts).get();
+}
 
-  // Acceleration time
-  int32_t acceleration_time = static_cast<int>(std::round(acc_time * 1000));
-  memcpy(&w.param[0], &acceleration_time, sizeof(int32_t));
+std::future<int> Commander::getActualCurrentAsync(double (&efforts)[6])
+{
+  return query<protocol::GetActualCurrent>(efforts);
+}
 
-  // PTP motion ratio
-  int32_t ratio_integer = static_cast<int>(std::round(ratio * 1000));
-  memcpy(&w.param[2], &ratio_integer, sizeof(int32_t));
+int Commander::getExtActualRPM(double (&velocities)[3])
+{
+  return getExtActualRPMAsync(velocities).get();
+}
 
-  // Smooth on between the points
-  w.param[4] = 1;
+std::future<int> Commander::getExtActualRPMAsync(double (&velocities)[3])
+{
+  return query<protocol::GetExtActualRPM>(velocities);
+}
 
-  double pos_deg;
-  int32_t deg_integer;
-  for (size_t i = 0; i < 6; i++)
-  {
-    pos_deg = positions[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(pos_deg));
-    memcpy(&w.param[(i * 2) + 5], &deg_integer, sizeof(int32_t));
-  }
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+int Commander::getExtActualPosition(double (&positions)[3])
+{
+  return getExtActualPositionAsync(positions).get();
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+std::future<int> Commander::getExtActualPositionAsync(double (&positions)[3])
+{
+  return query<protocol::GetExtActualPosition>(positions);
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+int Commander::getActualPosition(double (&positions)[6])
+{
+  return getActualPositionAsync(positions).get();
 }
 
-int Commander::extPtpJoint(double* positions)
+std::future<int> Commander::getActualPositionAsync(double (&positions)[6])
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  return query<protocol::GetActualPosition>(positions);
+}
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::ExtPtpJoint);
+int Commander::getMotionState(MotionStatus& status)
+{
+  return getMotionStateAsync(status).get();
+}
 
-  // Smooth on between the points
-  w.param[0] = 1;
+std::future<int> Commander::getMotionStateAsync(MotionStatus& status)
+{
+  return query<protocol::GetMotionState>(status);
+}
 
-  //
-  std::string pos_str = "";
-  for (size_t i = 0; i < 9; i++)
-  {
-    if (i != 0)
-    {
-      pos_str += ",";
-    }
-    std::stringstream stream;
-    stream << std::fixed << std::setprecision(7) << (positions[i] * (180 / M_PI));
-    pos_str += stream.str();
-  }
-  w.param[1] = pos_str.length();
-  std::copy(pos_str.begin(), pos_str.end(), &w.param[2]);
+int Commander::getErrorCode(ErrorList& errors)
+{
+  return getErrorCodeAsync(errors).get();
+}
 
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+std::future<int> Commander::getErrorCodeAsync(ErrorList& errors)
+{
+  return query<protocol::GetErrorCode>(errors);
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+int Commander::getErrorCode(std::vector<std::string>& error_list)
+{
+  return getErrorCodeAsync(error_list).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::getErrorCodeAsync(std::vector<std::string>& error_list)
+{
+  return query<protocol::GetErrorCode>(error_list);
 }
 
-int Commander::linearSplinePoint(const double* positions, double goal_time_sec)
+int Commander::getActualState(ActualState& state, bool external_axes)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  return getActualStateAsync(state, external_axes).get();
+}
+
+std::future<int> Commander::getActualStateAsync(ActualState& state, bool external_axes)
+{
+  const size_t count = external_axes ? ActualState::FIELD_COUNT : ActualState::ExtPosition;
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::LinearSplinePoint);
+  Commandformat w[ActualState::FIELD_COUNT];
+  protocol::GetActualPosition::encode(w[ActualState::Position]);
+  protocol::GetActualRPM::encode(w[ActualState::Velocity]);
+  protocol::GetActualCurrent::encode(w[ActualState::Effort]);
+  protocol::GetMotionState::encode(w[ActualState::Motion]);
+  protocol::GetErrorCode::encode(w[ActualState::Error]);
+  protocol::GetExtActualPosition::encode(w[ActualState::ExtPosition]);
+  protocol::GetExtActualRPM::encode(w[ActualState::ExtVelocity]);
 
-  double pos_deg;
-  int32_t deg_integer;
-  for (size_t i = 0; i < 9; i++)
+  for (size_t i = count; i < ActualState::FIELD_COUNT; i++)
   {
-    pos_deg = positions[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(pos_deg));
-    memcpy(&w.param[(i * 2) + 0], &deg_integer, sizeof(int32_t));
+    state.results[i] = COMMUNICATION_ERROR;
   }
 
-  int32_t t_integer = static_cast<int>(std::round(goal_time_sec * 1000.0));
-  memcpy(&w.param[18], &t_integer, sizeof(int32_t));
+  BatchHandler decode = [&state](size_t field, int result, const Responseformat& r) {
+    state.results[field] = result;
+    if (result != 0)
+    {
+      return;
+    }
 
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+    switch (field)
+    {
+      case ActualState::Position:
+        protocol::GetActualPosition::Reply::decode(r, state.positions);
+        break;
+      case ActualState::Velocity:
+        protocol::GetActualRPM::Reply::decode(r, state.velocities);
+        break;
+      case ActualState::Effort:
+        protocol::GetActualCurrent::Reply::decode(r, state.efforts);
+        break;
+      case ActualState::Motion:
+        protocol::GetMotionState::Reply::decode(r, state.motion_status);
+        break;
+      case ActualState::Error:
+        protocol::GetErrorCode::Reply::decode(r, state.errors);
+        break;
+      case ActualState::ExtPosition:
+        protocol::GetExtActualPosition::Reply::decode(r, state.ext_positions);
+        break;
+      case ActualState::ExtVelocity:
+        protocol::GetExtActualRPM::Reply::decode(r, state.ext_velocities);
+        break;
+    }
+  };
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return requestBatchAsync(w, count, decode, [&state, count]() {
+    for (size_t i = 0; i < count; i++)
+    {
+      if (state.results[i] != 0)
+      {
+        return state.results[i];
+      }
+    }
+    return 0;
+  });
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+int Commander::ptpJoint(double* positions)
+{
+  return ptpJointAsync(positions).get();
 }
 
-int Commander::CubicSplinePoint(const double* positions, const double* velocities, double goal_time_sec)
+std::future<int> Commander::ptpJointAsync(double* positions)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
+  return send<protocol::PtpJoint>(positions);
+}
 
-  w.cmd_id = static_cast<uint16_t>(CommandId::CubicSplinePoint);
+int Commander::ptpJoint(double* positions, double acc_time, double ratio)
+{
+  return ptpJointAsync(positions, acc_time, ratio).get();
+}
 
-  double deg_float;
-  int32_t deg_integer;
-  for (size_t i = 0; i < 9; i++)
-  {
-    deg_float = positions[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(deg_float));
-    std::cout << deg_integer << " ";
-    memcpy(&w.param[(i * 2) + 0], &deg_integer, sizeof(int32_t));
-  }
+std::future<int> Commander::ptpJointAsync(double* positions, double acc_time, double ratio)
+{
+  return send<protocol::PtpJointWithVelocity>(acc_time, ratio, positions);
+}
 
-  for (size_t i = 0; i < 9; i++)
-  {
-    deg_float = velocities[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(deg_float));
-    memcpy(&w.param[(i * 2) + 18], &deg_integer, sizeof(int32_t));
-  }
+int Commander::extPtpJoint(double* positions)
+{
+  return extPtpJointAsync(positions).get();
+}
 
-  int32_t t_integer = static_cast<int>(std::round(goal_time_sec * 1000.0));
-  memcpy(&w.param[36], &t_integer, sizeof(int32_t));
+std::future<int> Commander::extPtpJointAsync(double* positions)
+{
+  return send<protocol::ExtPtpJoint>(positions);
+}
 
-  TCPClient::write(data_w, sizeof(Commandformat), written);
+int Commander::linearSplinePoint(const double* positions, double goal_time_sec)
+{
+  return linearSplinePointAsync(positions, goal_time_sec).get();
+}
 
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+std::future<int> Commander::linearSplinePointAsync(const double* positions, double goal_time_sec)
+{
+  return send<protocol::LinearSplinePoint>(positions, goal_time_sec);
+}
+
+int Commander::CubicSplinePoint(const double* positions, const double* velocities, double goal_time_sec)
+{
+  return CubicSplinePointAsync(positions, velocities, goal_time_sec).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::CubicSplinePointAsync(const double* positions, const double* velocities,
+                                                 double goal_time_sec)
+{
+  return send<protocol::CubicSplinePoint>(positions, velocities, goal_time_sec);
 }
 
 int Commander::QuintSplinePoint(const double* positions, const double* velocities, const double* acceleration,
                                 double goal_time_sec)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::QuinticSplinePoint);
+  return QuintSplinePointAsync(positions, velocities, acceleration, goal_time_sec).get();
+}
 
-  double deg_float;
-  int32_t deg_integer;
-  for (size_t i = 0; i < 9; i++)
-  {
-    deg_float = positions[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(deg_float));
-    memcpy(&w.param[(i * 2) + 0], &deg_integer, sizeof(int32_t));
-  }
+std::future<int> Commander::QuintSplinePointAsync(const double* positions, const double* velocities,
+                                                 const double* acceleration, double goal_time_sec)
+{
+  return send<protocol::QuinticSplinePoint>(positions, velocities, acceleration, goal_time_sec);
+}
 
-  for (size_t i = 0; i < 9; i++)
-  {
-    deg_float = velocities[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(deg_float));
-    memcpy(&w.param[(i * 2) + 18], &deg_integer, sizeof(int32_t));
-  }
+std::future<int> Commander::sendFramesAsync(const Commandformat* frames, size_t count, int* results)
+{
+  return sendFrames(frames, count, results, true);
+}
 
-  for (size_t i = 0; i < 9; i++)
+bool Commander::trySendFramesAsync(const Commandformat* frames, size_t count, std::future<int>& result, int* results)
+{
+  std::future<int> sent = sendFrames(frames, count, results, false);
+  if (!sent.valid())
   {
-    deg_float = acceleration[i] * (180 / M_PI) * 1000.0;
-    deg_integer = static_cast<int>(std::round(deg_float));
-    memcpy(&w.param[(i * 2) + 36], &deg_integer, sizeof(int32_t));
+    return false;
   }
+  result = std::move(sent);
+  return true;
+}
 
-  int32_t t_integer = static_cast<int>(std::round(goal_time_sec * 1000.0));
-  memcpy(&w.param[54], &t_integer, sizeof(int32_t));
-
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::sendFrames(const Commandformat* frames, size_t count, int* results, bool wait)
+{
+  // Written by the receiver and, when a write fails, by the submitting thread
+  std::shared_ptr<std::atomic<int>> first_failure = std::make_shared<std::atomic<int>>(0);
+
+  return requestBatchAsync(
+      frames, count,
+      [first_failure, results](size_t index, int result, const Responseformat&) {
+        if (results)
+        {
+          results[index] = result;
+        }
+        int none = 0;
+        first_failure->compare_exchange_strong(none, result);
+      },
+      [first_failure]() { return first_failure->load(); }, wait);
 }
 
 int Commander::motionAbort()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::MotionAbort);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return motionAbortAsync().get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::motionAbortAsync()
+{
+  Commandformat w;
+  protocol::MotionAbort::encode(w);
+  return requestAsync(w, ResponseDecoder(), true);
 }
 
 int Commander::clearError()
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::ControllerReset);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return clearErrorAsync().get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::clearErrorAsync()
+{
+  return send<protocol::ControllerReset>();
 }
 
 int Commander::setPtpSpeed(int ratio)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::SetPtpSpeed);
-  w.param[0] = static_cast<uint16_t>(ratio);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return setPtpSpeedAsync(ratio).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::setPtpSpeedAsync(int ratio)
+{
+  return send<protocol::SetPtpSpeed>(ratio);
 }
 
 int Commander::getPtpSpeed(int& ratio)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetPtpSpeed);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
-  {
-    return r.result;
-  }
+  return getPtpSpeedAsync(ratio).get();
+}
 
-  uint16_t data_length = r.data[0];
-  ratio = static_cast<int>(r.data[1]);
-  return r.result;
+std::future<int> Commander::getPtpSpeedAsync(int& ratio)
+{
+  return query<protocol::GetPtpSpeed>(ratio);
 }
 
 int Commander::setOverrideRatio(int ratio)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::SetOverRideRatio);
-  w.param[0] = static_cast<uint16_t>(ratio);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return setOverrideRatioAsync(ratio).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::setOverrideRatioAsync(int ratio)
+{
+  return send<protocol::SetOverRideRatio>(ratio);
 }
 
 int Commander::getOverrideRatio(int& ratio)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetOverRideRatio);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
-  {
-    return r.result;
-  }
+  return getOverrideRatioAsync(ratio).get();
+}
 
-  uint16_t data_length = r.data[0];
-  ratio = static_cast<int>(r.data[1]);
-  return r.result;
+std::future<int> Commander::getOverrideRatioAsync(int& ratio)
+{
+  return query<protocol::GetOverRideRatio>(ratio);
 }
 
 int Commander::setRobotMode(ControlMode mode)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::SetRobotMode);
-  w.param[0] = static_cast<uint16_t>(mode);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
+  return setRobotModeAsync(mode).get();
+}
 
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  return r.result;
+std::future<int> Commander::setRobotModeAsync(ControlMode mode)
+{
+  return send<protocol::SetRobotMode>(mode);
 }
 
 int Commander::getRobotMode(ControlMode& mode)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetRobotMode);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
-  {
-    return r.result;
-  }
+  return getRobotModeAsync(mode).get();
+}
 
-  uint16_t data_length = r.data[0];
-  mode = static_cast<ControlMode>(r.data[1]);
-  return r.result;
+std::future<int> Commander::getRobotModeAsync(ControlMode& mode)
+{
+  return query<protocol::GetRobotMode>(mode);
 }
 
 int Commander::GetRobotVersion(std::string& str)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetRobotVersion);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
-  {
-    return r.result;
-  }
+  return GetRobotVersionAsync(str).get();
+}
 
-  uint16_t data_length = r.data[0];
-  uint16_t str_length = r.data[1];
-  str = "";
-  for (size_t i = 0; i < str_length; i++)
-  {
-    str += r.data[i + 2];
-  }
-  return r.result;
+std::future<int> Commander::GetRobotVersionAsync(std::string& str)
+{
+  return query<protocol::GetRobotVersion>(str);
 }
 
 int Commander::GetHRSSVersion(std::string& str)
 {
-  size_t written;
-  Commandformat w = {};
-  const uint8_t* data_w = static_cast<const uint8_t*>(static_cast<void*>(&w));
-
-  w.cmd_id = static_cast<uint16_t>(CommandId::GetHRSSVersion);
-  TCPClient::write(data_w, sizeof(Commandformat), written);
-
-  size_t read_chars;
-  Responseformat r = {};
-  uint8_t* data_r = static_cast<uint8_t*>(static_cast<void*>(&r));
-
-  TCPClient::read(data_r, sizeof(Responseformat), read_chars);
-  if (r.result != 0)
-  {
-    return r.result;
-  }
-
-  std::stringstream ss;
-  ss << r.data[2] << "." << r.data[3] << "." << static_cast<char>(r.data[4]) << "_" << r.data[5];
-
-  str = ss.str();
+  return GetHRSSVersionAsync(str).get();
+}
 
-  return r.result;
+std::future<int> Commander::GetHRSSVersionAsync(std::string& str)
+{
+  return query<protocol::GetHRSSVersion>(str);
 }
 
 }  // namespace hrsdk
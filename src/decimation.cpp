@@ -0,0 +1,221 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <hiwin_robot_client_library/decimation.hpp>
+
+namespace hrsdk
+{
+/*
+ * Coefficients, lowest order first, of the spline of \p type from point i to point k of
+ * \p trajectory over \p t seconds, for one axis
+ */
+static void splineCoefficients(const TrajectoryBuffer& trajectory, TrajectoryType type, size_t axis, size_t i,
+                               size_t k, double t, double (&c)[6])
+{
+  const double p0 = trajectory.positions[axis][i];
+  const double h = trajectory.positions[axis][k] - p0;
+  const double t2 = t * t;
+  const double t3 = t2 * t;
+  std::fill(c, c + 6, 0.0);
+  c[0] = p0;
+
+  switch (type)
+  {
+    case TrajectoryType::Linear:
+      c[1] = h / t;
+      break;
+    case TrajectoryType::Cubic:
+    {
+      const double v0 = trajectory.velocities[axis][i];
+      const double v1 = trajectory.velocities[axis][k];
+      c[1] = v0;
+      c[2] = (3 * h - (2 * v0 + v1) * t) / t2;
+      c[3] = (-2 * h + (v0 + v1) * t) / t3;
+      break;
+    }
+    case TrajectoryType::Quintic:
+    {
+      const double v0 = trajectory.velocities[axis][i];
+      const double v1 = trajectory.velocities[axis][k];
+      const double a0 = trajectory.accelerations[axis][i];
+      const double a1 = trajectory.accelerations[axis][k];
+      c[1] = v0;
+      c[2] = 0.5 * a0;
+      c[3] = (20 * h - (8 * v1 + 12 * v0) * t - (3 * a0 - a1) * t2) / (2 * t3);
+      c[4] = (-30 * h + (14 * v1 + 16 * v0) * t + (3 * a0 - 2 * a1) * t2) / (2 * t3 * t);
+      c[5] = (12 * h - 6 * (v1 + v0) * t + (a1 - a0) * t2) / (2 * t3 * t2);
+      break;
+    }
+  }
+}
+
+bool decimateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const double* tolerances,
+                        std::vector<size_t>& kept)
+{
+  const size_t points = trajectory.size();
+  const size_t axes = trajectory.axis_count;
+  if (axes == 0 || axes > TRAJECTORY_MAX_AXES)
+  {
+    return false;
+  }
+
+  double inverse_tolerances[TRAJECTORY_MAX_AXES];
+  for (size_t axis = 0; axis < axes; axis++)
+  {
+    if (!(tolerances[axis] > 0))
+    {
+      return false;
+    }
+    inverse_tolerances[axis] = 1.0 / tolerances[axis];
+  }
+
+  kept.clear();
+  if (points <= 2)
+  {
+    for (size_t i = 0; i < points; i++)
+    {
+      kept.push_back(i);
+    }
+    return true;
+  }
+
+  // Time of each point since the first one
+  std::vector<double> times(points);
+  times[0] = 0;
+  for (size_t i = 1; i < points; i++)
+  {
+    times[i] = times[i - 1] + trajectory.goal_times[i];
+  }
+
+  std::vector<char> keep(points, 0);
+  keep[0] = 1;
+  keep[points - 1] = 1;
+
+  // Spans (first, last) of kept points still to check, worked off depth first
+  std::vector<std::pair<size_t, size_t>> spans;
+  spans.push_back(std::make_pair(0, points - 1));
+  while (!spans.empty())
+  {
+    const size_t first = spans.back().first;
+    const size_t last = spans.back().second;
+    spans.pop_back();
+    if (last - first < 2)
+    {
+      continue;
+    }
+
+    double coefficients[TRAJECTORY_MAX_AXES][6];
+    const double span_time = times[last] - times[first];
+    for (size_t axis = 0; axis < axes; axis++)
+    {
+      splineCoefficients(trajectory, type, axis, first, last, span_time, coefficients[axis]);
+    }
+
+    // Largest deviation in units of the tolerances, and where it occurs
+    double worst = 0;
+    size_t worst_index = first;
+    for (size_t m = first + 1; m < last; m++)
+    {
+      const double t = times[m] - times[first];
+      for (size_t axis = 0; axis < axes; axis++)
+      {
+        const double* c = coefficients[axis];
+        double position = c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * (c[4] + t * c[5]))));
+        double deviation = std::fabs(position - trajectory.positions[axis][m]) * inverse_tolerances[axis];
+        if (deviation > worst)
+        {
+          worst = deviation;
+          worst_index = m;
+        }
+      }
+    }
+
+    // A span without time, e.g. repeated points, cannot be interpolated and keeps all its points
+    if (worst > 1 || !(span_time > 0))
+    {
+      if (worst_index == first)
+      {
+        worst_index = first + (last - first) / 2;
+      }
+      keep[worst_index] = 1;
+      spans.push_back(std::make_pair(first, worst_index));
+      spans.push_back(std::make_pair(worst_index, last));
+    }
+  }
+
+  for (size_t i = 0; i < points; i++)
+  {
+    if (keep[i])
+    {
+      kept.push_back(i);
+    }
+  }
+  return true;
+}
+
+bool decimateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const double* tolerances,
+                        TrajectoryBuffer& decimated)
+{
+  std::vector<size_t> kept;
+  if (!decimateTrajectory(trajectory, type, tolerances, kept))
+  {
+    return false;
+  }
+
+  // Built apart and moved in at the end, so decimated may be trajectory itself
+  const size_t axes = trajectory.axis_count;
+  TrajectoryBuffer result;
+  result.resize(axes, kept.size());
+  for (size_t j = 0; j < kept.size(); j++)
+  {
+    const size_t i = kept[j];
+    for (size_t axis = 0; axis < axes; axis++)
+    {
+      result.positions[axis][j] = trajectory.positions[axis][i];
+      result.velocities[axis][j] = trajectory.velocities[axis][i];
+      result.accelerations[axis][j] = trajectory.accelerations[axis][i];
+    }
+
+    // Goal time from the previous kept point, through every dropped one
+    double goal_time = trajectory.goal_times[i];
+    for (size_t dropped = j > 0 ? kept[j - 1] + 1 : i; dropped < i; dropped++)
+    {
+      goal_time += trajectory.goal_times[dropped];
+    }
+    result.goal_times[j] = goal_time;
+  }
+
+  decimated = std::move(result);
+  return true;
+}
+
+}  // namespace hrsdk
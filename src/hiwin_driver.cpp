@@ -26,19 +26,39 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <regex>
 #include <iostream>
 #include <cstring>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
 #include <bits/stdc++.h>
 
 #include <hiwin_robot_client_library/hiwin_driver.hpp>
 
 namespace hrsdk
 {
-HIWINDriver::HIWINDriver(const std::string& robot_ip) : robot_ip_(robot_ip)
+constexpr std::chrono::milliseconds HIWINDriver::DEFAULT_CONNECT_TIMEOUT;
+
+HIWINDriver::HIWINDriver(const std::string& robot_ip)
+  : robot_ip_(robot_ip)
+  , version_number_("0.0.0")
+  , version_()
+  , ptp_profile_()
+  , trajectory_window_(DEFAULT_TRAJECTORY_WINDOW)
+  , trajectory_lookahead_(DEFAULT_TRAJECTORY_LOOKAHEAD)
+  , joint_limits_()
+  , reactor_(nullptr)
+  , connect_timeout_(DEFAULT_CONNECT_TIMEOUT)
+  , bring_up_status_()
+  , monitor_running_(false)
+  , monitor_period_(0)
+  , monitor_axes_(6)
+  , streaming_running_(false)
+  , streaming_options_()
 {
 }
 
@@ -54,100 +74,551 @@ bool HIWINDriver::connect()
 
 bool HIWINDriver::connect(int command_port, int event_port, int file_port)
 {
+  // Dial all three sockets at once so an unreachable robot costs one timeout, not three
+  std::vector<socket::TCPClient*> clients;
+  beginConnect(command_port, event_port, file_port, clients);
+  socket::TCPClient::connectAll(clients.data(), clients.size(), connect_timeout_);
+
+  return finishConnect();
+}
+
+void HIWINDriver::beginConnect(int command_port, int event_port, int file_port,
+                               std::vector<socket::TCPClient*>& clients)
+{
+  // Both threads call into the clients replaced below
+  stopStreaming();
+  stopMonitor();
+  detachReactor();
+
   commander_.reset(new hrsdk::Commander(robot_ip_, command_port));
-  if (!commander_->connect())
+  commander_->setReactor(reactor_);
+  event_cb_.reset(new hrsdk::EventCb(robot_ip_, event_port));
+  file_client_.reset(new hrsdk::FileClient(robot_ip_, file_port));
+
+  commander_->beginConnect(robot_ip_, command_port);
+  event_cb_->beginConnect(robot_ip_, event_port);
+  file_client_->beginConnect(robot_ip_, file_port);
+  clients.push_back(commander_.get());
+  clients.push_back(event_cb_.get());
+  clients.push_back(file_client_.get());
+}
+
+bool HIWINDriver::finishConnect()
+{
+  if (!commander_ || commander_->getState() != socket::SocketState::Connected ||
+      event_cb_->getState() != socket::SocketState::Connected ||
+      file_client_->getState() != socket::SocketState::Connected)
   {
     return false;
   }
+  commander_->setPipelineDepth(COMMAND_PIPELINE_DEPTH);
 
-  event_cb_.reset(new hrsdk::EventCb(robot_ip_, event_port));
-  if (!event_cb_->connect())
+  if (reactor_ != nullptr && (!reactor_->add(event_cb_.get()) || !reactor_->add(file_client_.get())))
   {
     return false;
   }
 
-  file_client_.reset(new hrsdk::FileClient(robot_ip_, file_port));
-  if (!file_client_->connect())
+  // The version is parsed even then, GetRobotVersion may well have succeeded
+  bool up = bringUp();
+  parseVersion();
+
+  return up;
+}
+
+bool HIWINDriver::bringUp()
+{
+  static const char* const STEP_NAMES[BringUpStatus::STEP_COUNT] = {
+    "GetRobotVersion", "getPermissions",   "setLogLevel",     "setRobotMode",
+    "setPtpSpeed",     "setOverrideRatio", "setServoAmpState"
+  };
+
+  // Sent back to back in this order; the controller still applies them one after another
+  std::future<int> steps[BringUpStatus::STEP_COUNT];
+  steps[BringUpStatus::RobotVersion] = commander_->GetRobotVersionAsync(version_info_);
+  steps[BringUpStatus::Permissions] = commander_->getPermissionsAsync();
+  steps[BringUpStatus::LogLevel] = commander_->setLogLevelAsync(LogLevels::SetCommand);
+  steps[BringUpStatus::RobotMode] = commander_->setRobotModeAsync(ControlMode::Auto);
+  steps[BringUpStatus::PtpSpeed] = commander_->setPtpSpeedAsync(100);
+  steps[BringUpStatus::OverrideRatio] = commander_->setOverrideRatioAsync(100);
+  steps[BringUpStatus::ServoAmp] = commander_->setServoAmpStateAsync(true);
+
+  bool ok = true;
+  for (size_t i = 0; i < BringUpStatus::STEP_COUNT; i++)
   {
-    return false;
+    bring_up_status_.results[i] = steps[i].get();
+    if (bring_up_status_.results[i] != 0)
+    {
+      std::cout << "Bring-up step " << STEP_NAMES[i] << " failed with " << bring_up_status_.results[i] << std::endl;
+      ok = false;
+    }
   }
 
-  commander_->GetRobotVersion(version_info_);
   std::cout << version_info_ << std::endl;
+  return ok;
+}
 
-  commander_->getPermissions();
-  commander_->setLogLevel(LogLevels::SetCommand);
+BringUpStatus HIWINDriver::getBringUpStatus() const
+{
+  return bring_up_status_;
+}
 
-  commander_->setRobotMode(ControlMode::Auto);
-  commander_->setPtpSpeed(100);
-  commander_->setOverrideRatio(100);
+void HIWINDriver::disconnect()
+{
+  stopStreaming();
+  stopMonitor();
+  detachReactor();
 
-  commander_->setServoAmpState(true);
+  if (commander_)
+  {
+    commander_->disconnect();
+  }
+  if (event_cb_)
+  {
+    event_cb_->close();
+  }
+  if (file_client_)
+  {
+    file_client_->close();
+  }
+}
 
-  return true;
+void HIWINDriver::setConnectTimeout(std::chrono::milliseconds timeout)
+{
+  connect_timeout_ = timeout;
 }
 
-void HIWINDriver::disconnect()
+ConnectionStatus HIWINDriver::getConnectionStatus()
 {
+  ConnectionStatus status;
+  status.command = commander_ ? commander_->getState() : socket::SocketState::Invalid;
+  status.event = event_cb_ ? event_cb_->getState() : socket::SocketState::Invalid;
+  status.file = file_client_ ? file_client_->getState() : socket::SocketState::Invalid;
+  return status;
 }
 
-void HIWINDriver::getRobotVersion(std::string& version)
+void HIWINDriver::setReactor(hrsdk::socket::Reactor* reactor)
 {
-  std::regex version_regex(R"(HRDLL (\d+\.\d+\.\d+))");
-  std::smatch match;
+  reactor_ = reactor;
+}
 
-  if (std::regex_search(version_info_, match, version_regex))
-  {
-    version_number_ = match[1].str();
-  }
-  else
+void HIWINDriver::detachReactor()
+{
+  // The reactor holds raw pointers to the sockets, so they must leave it before they are destroyed.
+  // The commander takes care of itself on disconnect.
+  if (reactor_ != nullptr)
   {
-    version_regex = std::regex(R"(HRSS (\d+\.\d+\.\d+))");
-    if (std::regex_search(version_info_, match, version_regex))
+    if (event_cb_)
     {
-      version_number_ = match[1].str();
+      reactor_->remove(event_cb_.get());
     }
-    else
+    if (file_client_)
     {
-      version_number_ = "0.0.0";
+      reactor_->remove(file_client_.get());
     }
   }
+}
 
-  version = version_number_;
+bool HIWINDriver::startMonitor(std::chrono::microseconds period, size_t axis_count)
+{
+  if (monitor_running_ || !commander_ || axis_count < 6 || axis_count > RobotStateSnapshot::MAX_AXES)
+  {
+    return false;
+  }
+
+  monitor_period_ = period;
+  monitor_axes_ = axis_count;
+  monitor_running_ = true;
+  monitor_thread_ = std::thread(&HIWINDriver::monitorLoop, this);
+  return true;
+}
+
+void HIWINDriver::stopMonitor()
+{
+  monitor_running_ = false;
+  if (monitor_thread_.joinable())
+  {
+    monitor_thread_.join();
+  }
+}
+
+bool HIWINDriver::isMonitorRunning() const
+{
+  return monitor_running_;
+}
+
+bool HIWINDriver::getMonitoredState(RobotStateSnapshot& state) const
+{
+  return monitored_state_.load(state) != 0;
+}
+
+void HIWINDriver::monitorLoop()
+{
+  RobotStateSnapshot state = {};
+  std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+  while (monitor_running_)
+  {
+    readState(state, monitor_axes_);
+    monitored_state_.store(state);
+
+    // Skip the missed periods rather than catching up with a burst of reads
+    next = std::max(next + monitor_period_, std::chrono::steady_clock::now());
+    std::this_thread::sleep_until(next);
+  }
+}
+
+bool HIWINDriver::startStreaming(const StreamingOptions& options)
+{
+  if (streaming_running_)
+  {
+    return false;
+  }
+
+  online_generator_.reset();
+  return launchStreaming(options);
 }
 
-bool HIWINDriver::isVersionGreaterOrEqual(const std::string& requiredVersion)
+bool HIWINDriver::startOnlineTrajectory(const JointLimits& limits, const TrajectoryPoint& start,
+                                        const StreamingOptions& options)
 {
-  std::vector<int> versionParts, requiredParts;
+  if (streaming_running_ || limits.axis_count == 0 || limits.axis_count > TRAJECTORY_MAX_AXES)
+  {
+    return false;
+  }
+
+  const double cycle_time = std::chrono::duration<double>(options.period).count();
+  online_generator_.reset(new OnlineTrajectoryGenerator(limits, cycle_time));
+  online_generator_->reset(start);
+
+  StreamingOptions quintic = options;
+  quintic.type = TrajectoryType::Quintic;
+  return launchStreaming(quintic);
+}
 
-  std::stringstream versionStream(version_number_);
-  std::stringstream requiredStream(requiredVersion);
-  std::string part;
+void HIWINDriver::setOnlineTarget(const TrajectoryPoint& target)
+{
+  online_target_.post(target);
+}
 
-  while (std::getline(versionStream, part, '.'))
+bool HIWINDriver::launchStreaming(const StreamingOptions& options)
+{
+  if (!commander_ || options.period <= std::chrono::nanoseconds::zero())
   {
-    versionParts.push_back(std::stoi(part));
+    return false;
   }
-  while (std::getline(requiredStream, part, '.'))
+
+  streaming_options_ = options;
+  streaming_stats_.store(StreamingStats());
+  streaming_running_ = true;
+  streaming_thread_ = std::thread(&HIWINDriver::streamingLoop, this);
+  return true;
+}
+
+void HIWINDriver::stopStreaming()
+{
+  streaming_running_ = false;
+  if (streaming_thread_.joinable())
   {
-    requiredParts.push_back(std::stoi(part));
+    streaming_thread_.join();
   }
+}
+
+bool HIWINDriver::isStreaming() const
+{
+  return streaming_running_;
+}
 
-  for (size_t i = 0; i < std::max(versionParts.size(), requiredParts.size()); ++i)
+void HIWINDriver::setSetpoint(const TrajectoryPoint& point)
+{
+  Setpoint setpoint;
+  setpoint.point = point;
+  setpoint.joint_axes = 0;
+  setpoint_.post(setpoint);
+}
+
+void HIWINDriver::setJointSetpoint(const std::vector<double>& positions)
+{
+  if (positions.empty() || positions.size() > TRAJECTORY_MAX_AXES)
   {
-    int versionPart = (i < versionParts.size()) ? versionParts[i] : 0;
-    int requiredPart = (i < requiredParts.size()) ? requiredParts[i] : 0;
+    return;
+  }
+
+  Setpoint setpoint = {};
+  std::copy(positions.begin(), positions.end(), setpoint.point.positions);
+  setpoint.joint_axes = positions.size();
+  setpoint_.post(setpoint);
+}
 
-    if (versionPart > requiredPart)
+StreamingStats HIWINDriver::getStreamingStats() const
+{
+  StreamingStats stats;
+  streaming_stats_.load(stats);
+  return stats;
+}
+
+static const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+
+static void addNanoseconds(timespec& t, int64_t ns)
+{
+  int64_t total = t.tv_nsec + ns;
+  t.tv_sec += total / NANOSECONDS_PER_SECOND;
+  t.tv_nsec = total % NANOSECONDS_PER_SECOND;
+}
+
+static int64_t nanosecondsBetween(const timespec& from, const timespec& to)
+{
+  return (to.tv_sec - from.tv_sec) * NANOSECONDS_PER_SECOND + (to.tv_nsec - from.tv_nsec);
+}
+
+// Applies the scheduling options to the calling thread, reporting the ones that could not be applied
+static void applyRealtimeOptions(const StreamingOptions& options)
+{
+  if (options.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    std::cout << "Streaming: mlockall failed: " << std::strerror(errno) << std::endl;
+  }
+
+  if (options.cpu >= 0)
+  {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(options.cpu, &cpus);
+    int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (error != 0)
     {
-      return true;
+      std::cout << "Streaming: cannot pin to CPU " << options.cpu << ": " << std::strerror(error) << std::endl;
     }
-    if (versionPart < requiredPart)
+  }
+
+  if (options.priority > 0)
+  {
+    sched_param param = {};
+    param.sched_priority = options.priority;
+    int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0)
     {
-      return false;
+      std::cout << "Streaming: cannot set SCHED_FIFO priority " << options.priority << ": " << std::strerror(error)
+                << std::endl;
     }
   }
-  return true;
+}
+
+void HIWINDriver::streamingLoop()
+{
+  applyRealtimeOptions(streaming_options_);
+
+  const int64_t period_ns = streaming_options_.period.count();
+  const double period_sec = period_ns / static_cast<double>(NANOSECONDS_PER_SECOND);
+
+  StreamingStats stats = {};
+  std::deque<std::future<int>> in_flight;
+  setpoint_.clear();
+  online_target_.clear();
+  Setpoint setpoint;
+  TrajectoryPoint point;
+  TrajectoryPoint target;
+
+  // Encoded setpoint that found the command pipeline busy with other commands. It goes out in a
+  // later cycle, unless a newer setpoint replaces it first.
+  Commandformat frame;
+  bool frame_ready = false;
+
+  // Collects acknowledgements, waiting for all of them when \p all is set
+  auto reap = [&](bool all) {
+    while (!in_flight.empty() &&
+           (all || in_flight.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+    {
+      stats.last_result = in_flight.front().get();
+      if (stats.last_result != 0)
+      {
+        stats.failures++;
+      }
+      in_flight.pop_front();
+    }
+  };
+
+  // Sends the encoded frame without waiting for other commands on the socket, keeping it for the
+  // next cycle if it would have to
+  auto trySend = [&]() {
+    std::future<int> result;
+    if (!commander_->trySendFramesAsync(&frame, 1, result))
+    {
+      stats.overruns++;
+      return;
+    }
+    in_flight.push_back(std::move(result));
+    frame_ready = false;
+    stats.sent++;
+  };
+
+  timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+  while (streaming_running_)
+  {
+    addNanoseconds(deadline, period_ns);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    stats.cycles++;
+    stats.last_lateness_ns = nanosecondsBetween(deadline, now);
+    stats.max_lateness_ns = std::max(stats.max_lateness_ns, stats.last_lateness_ns);
+
+    // Skip the periods already over instead of sending a burst to catch up
+    if (stats.last_lateness_ns >= period_ns)
+    {
+      int64_t missed = stats.last_lateness_ns / period_ns;
+      stats.deadline_misses += missed;
+      stats.cycles += missed;
+      addNanoseconds(deadline, missed * period_ns);
+    }
+
+    reap(false);
+
+    if (online_generator_)
+    {
+      if (online_target_.take(target))
+      {
+        online_generator_->setTarget(target.positions);
+      }
+      stats.dropped = online_target_.dropped();
+      stats.coalesced = online_target_.coalesced();
+
+      // The generator only advances when its state can be sent, so the points stay contiguous
+      if (in_flight.size() >= trajectory_window_)
+      {
+        stats.throttled++;
+      }
+      else if (frame_ready)
+      {
+        trySend();
+      }
+      else if (!online_generator_->update(point))
+      {
+        stats.idle++;
+      }
+      else
+      {
+        encodeTrajectoryPoint(frame, point, TrajectoryType::Quintic, period_sec);
+        frame_ready = true;
+        trySend();
+      }
+    }
+    else
+    {
+      // A setpoint that has to wait for the trajectory window stays in the mailbox, where a newer
+      // one replaces it; one already taken that waits for the pipeline is replaced the same way
+      if (!setpoint_.hasNew() && !frame_ready)
+      {
+        stats.idle++;
+      }
+      else if (in_flight.size() >= trajectory_window_)
+      {
+        stats.throttled++;
+      }
+      else if (!setpoint_.hasNew())
+      {
+        trySend();
+      }
+      else if (!setpoint_.take(setpoint))
+      {
+        // Caught a post half way; the controller keeps the last setpoint and this one goes next cycle
+        stats.idle++;
+      }
+      else
+      {
+        const TrajectoryPoint& next = setpoint.point;
+        if (setpoint.joint_axes > 0)
+        {
+          encodeJointCommand(frame, next.positions, setpoint.joint_axes);
+        }
+        else
+        {
+          encodeTrajectoryPoint(frame, next, streaming_options_.type,
+                                next.goal_time > 0.0 ? next.goal_time : period_sec);
+        }
+        frame_ready = true;
+        trySend();
+      }
+      stats.dropped = setpoint_.dropped();
+      stats.coalesced = setpoint_.coalesced();
+    }
+
+    streaming_stats_.store(stats);
+  }
+
+  reap(true);
+  streaming_stats_.store(stats);
+}
+
+bool HIWINDriver::loadMonitoredState(RobotStateSnapshot& state, size_t axis_count)
+{
+  if (!monitor_running_ || !getMonitoredState(state))
+  {
+    return false;
+  }
+  return axis_count <= state.axis_count;
+}
+
+// Reads "<tag> <major>.<minor>.<patch>" from the version string, as GetRobotVersion reports it
+static bool findVersion(const std::string& info, const char* tag, RobotVersion& version)
+{
+  size_t start = info.find(tag);
+  if (start == std::string::npos)
+  {
+    return false;
+  }
+
+  return sscanf(info.c_str() + start + strlen(tag), "%d.%d.%d", &version.major, &version.minor, &version.patch) == 3;
+}
+
+static bool versionGreaterOrEqual(const RobotVersion& version, const RobotVersion& required)
+{
+  if (version.major != required.major)
+  {
+    return version.major > required.major;
+  }
+  if (version.minor != required.minor)
+  {
+    return version.minor > required.minor;
+  }
+  return version.patch >= required.patch;
+}
+
+void HIWINDriver::parseVersion()
+{
+  if (!findVersion(version_info_, "HRDLL ", version_) && !findVersion(version_info_, "HRSS ", version_))
+  {
+    version_ = RobotVersion();
+  }
+  version_number_ = std::to_string(version_.major) + "." + std::to_string(version_.minor) + "." +
+                    std::to_string(version_.patch);
+}
+
+void HIWINDriver::getRobotVersion(std::string& version)
+{
+  version = version_number_;
+}
+
+RobotVersion HIWINDriver::getRobotVersion() const
+{
+  return version_;
+}
+
+bool HIWINDriver::isVersionGreaterOrEqual(const std::string& requiredVersion) const
+{
+  // Missing parts count as 0, so "3.3" is 3.3.0
+  RobotVersion required = RobotVersion();
+  sscanf(requiredVersion.c_str(), "%d.%d.%d", &required.major, &required.minor, &required.patch);
+  return versionGreaterOrEqual(version_, required);
+}
+
+bool HIWINDriver::isVersionGreaterOrEqual(const RobotVersion& required) const
+{
+  return versionGreaterOrEqual(version_, required);
 }
 
 void HIWINDriver::getRobotMode(ControlMode& mode)
@@ -178,6 +649,12 @@ bool HIWINDriver::isMotionPossible()
 
 bool HIWINDriver::isInMotion()
 {
+  RobotStateSnapshot state;
+  if (loadMonitoredState(state, 0))
+  {
+    return state.motion_valid && state.in_motion;
+  }
+
   MotionStatus robotStatus;
 
   commander_->getMotionState(robotStatus);
@@ -190,41 +667,108 @@ bool HIWINDriver::isInMotion()
 
 bool HIWINDriver::isInError()
 {
-  std::vector<std::string> error_list;
+  RobotStateSnapshot state;
+  if (loadMonitoredState(state, 0))
+  {
+    return state.error_valid && state.in_error;
+  }
 
-  commander_->getErrorCode(error_list);
-  if (error_list.empty())
+  ErrorList errors;
+  if (commander_->getErrorCode(errors) != 0)
   {
     return false;
   }
-  return true;
+  return !errors.empty();
 }
 
 void HIWINDriver::getErrorCode(int32_t& error_code)
 {
-  std::vector<std::string> error_list;
+  ErrorList errors;
+  error_code = commander_->getErrorCode(errors) == 0 ? errors.back() : 0;
+}
+
+bool HIWINDriver::readState(RobotStateSnapshot& state, size_t axis_count)
+{
+  return readStateAsync(state, axis_count).get();
+}
 
-  commander_->getErrorCode(error_list);
-  if (error_list.empty())
+std::future<bool> HIWINDriver::readStateAsync(RobotStateSnapshot& state, size_t axis_count)
+{
+  if (axis_count < 6 || axis_count > RobotStateSnapshot::MAX_AXES || !commander_)
   {
-    error_code = 0;
-    return;
+    std::promise<bool> failed;
+    failed.set_value(false);
+    return failed.get_future();
   }
 
-  std::string last_error = error_list.back();
+  std::shared_ptr<ActualState> actual = std::make_shared<ActualState>();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::shared_future<int> reply = commander_->getActualStateAsync(*actual, axis_count > 6).share();
 
-  std::regex pattern(R"(Err([0-9A-Fa-f]{2})-([0-9A-Fa-f]{2})-([0-9A-Fa-f]{2}))");
-  std::smatch matches;
+  // Deferred, so the decoding below runs in whichever thread waits for the result
+  return std::async(std::launch::deferred, [&state, axis_count, actual, start, reply]() {
+    reply.wait();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return fillSnapshot(*actual, axis_count, start, end, state);
+  });
+}
+
+bool HIWINDriver::fillSnapshot(const ActualState& actual, size_t axis_count,
+                               std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end,
+                               RobotStateSnapshot& state)
+{
+  const int* results = actual.results;
+  const bool external = axis_count > 6;
 
-  if (std::regex_match(last_error, matches, pattern))
+  state.axis_count = axis_count;
+  state.stamp_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>((start + (end - start) / 2).time_since_epoch()).count();
+
+  state.position_valid = results[ActualState::Position] == 0 && (!external || results[ActualState::ExtPosition] == 0);
+  if (state.position_valid)
   {
-    uint16_t first = std::stoi(matches[1].str(), nullptr, 16);
-    uint16_t second = std::stoi(matches[2].str(), nullptr, 16);
-    uint16_t third = std::stoi(matches[3].str(), nullptr, 16);
+    std::copy(actual.positions, actual.positions + 6, state.positions);
+    std::copy(actual.ext_positions, actual.ext_positions + (axis_count - 6), state.positions + 6);
+  }
 
-    error_code = (first << 16) | (second << 8) | (third << 0);
+  state.velocity_valid = results[ActualState::Velocity] == 0 && (!external || results[ActualState::ExtVelocity] == 0);
+  if (state.velocity_valid)
+  {
+    std::copy(actual.velocities, actual.velocities + 6, state.velocities);
+    std::copy(actual.ext_velocities, actual.ext_velocities + (axis_count - 6), state.velocities + 6);
   }
-  return;
+
+  state.effort_valid = results[ActualState::Effort] == 0;
+  if (state.effort_valid)
+  {
+    std::copy(actual.efforts, actual.efforts + 6, state.efforts);
+    std::fill(state.efforts + 6, state.efforts + axis_count, 0.0);
+  }
+
+  state.motion_valid = results[ActualState::Motion] == 0;
+  if (state.motion_valid)
+  {
+    state.in_motion = actual.motion_status == MotionStatus::Moving;
+  }
+
+  state.error_valid = results[ActualState::Error] == 0;
+  if (state.error_valid)
+  {
+    state.in_error = !actual.errors.empty();
+    state.error_code = actual.errors.back();
+  }
+
+  return state.position_valid && state.velocity_valid && state.effort_valid && state.motion_valid &&
+         state.error_valid;
+}
+
+LatencyStats HIWINDriver::getLatencyStats()
+{
+  if (!commander_)
+  {
+    return LatencyStats();
+  }
+  return commander_->getLatencyStats();
 }
 
 void HIWINDriver::getJointVelocity(std::vector<double>& velocities)
@@ -234,6 +778,16 @@ void HIWINDriver::getJointVelocity(std::vector<double>& velocities)
     return;
   }
 
+  RobotStateSnapshot state;
+  if (loadMonitoredState(state, velocities.size()))
+  {
+    if (state.velocity_valid)
+    {
+      std::copy(state.velocities, state.velocities + velocities.size(), velocities.begin());
+    }
+    return;
+  }
+
   double value[6];
   double extra_value[3];
 
@@ -268,6 +822,16 @@ void HIWINDriver::getJointEffort(std::vector<double>& efforts)
     return;
   }
 
+  RobotStateSnapshot state;
+  if (loadMonitoredState(state, efforts.size()))
+  {
+    if (state.effort_valid)
+    {
+      std::copy(state.efforts, state.efforts + efforts.size(), efforts.begin());
+    }
+    return;
+  }
+
   double value[6];
   double extra_value[6];
   if (commander_->getActualCurrent(value) != 0)
@@ -293,6 +857,16 @@ void HIWINDriver::getJointPosition(std::vector<double>& positions)
     return;
   }
 
+  RobotStateSnapshot state;
+  if (loadMonitoredState(state, positions.size()))
+  {
+    if (state.position_valid)
+    {
+      std::copy(state.positions, state.positions + positions.size(), positions.begin());
+    }
+    return;
+  }
+
   double value[6];
   double extra_value[3];
   if (commander_->getActualPosition(value) != 0)
@@ -329,14 +903,38 @@ void HIWINDriver::writeJointCommand(const std::vector<double>& positions)
   double value[9] = { 0.0 };
   std::copy(positions.begin(), positions.end(), value);
 
-  if (positions.size() > 6)
+  Commandformat w;
+  encodeJointCommand(w, value, positions.size());
+  commander_->sendFramesAsync(&w, 1).wait();
+}
+
+void HIWINDriver::encodeJointCommand(Commandformat& w, const double* positions, size_t axis_count) const
+{
+  if (axis_count > 6)
   {
-    commander_->extPtpJoint(value);
+    // The binary encoding has no room for external axes
+    protocol::ExtPtpJoint::encode(w, positions);
+    return;
   }
-  else
+
+  PtpProfile profile;
+  ptp_profile_.load(profile);
+  if (profile.set)
   {
-    commander_->ptpJoint(value);
+    protocol::PtpJointWithVelocity::encode(w, profile.acc_time, profile.ratio, positions);
+    return;
   }
+  protocol::PtpJoint::encode(w, positions);
+}
+
+void HIWINDriver::setPtpProfile(double acc_time, double ratio)
+{
+  ptp_profile_.store(PtpProfile{ true, acc_time, ratio });
+}
+
+void HIWINDriver::clearPtpProfile()
+{
+  ptp_profile_.store(PtpProfile{ false, 0.0, 0.0 });
 }
 
 void HIWINDriver::writeTrajectorySplinePoint(const std::vector<double>& positions, const float goal_time)
@@ -390,6 +988,173 @@ void HIWINDriver::writeTrajectorySplinePoint(const std::vector<double>& position
   commander_->QuintSplinePoint(p, v, a, goal_time);
 }
 
+TrajectoryResult HIWINDriver::writeTrajectory(const std::vector<TrajectoryPoint>& points, TrajectoryType type,
+                                              const TrajectoryProgressCallback& on_progress)
+{
+  return writeTrajectory(*CompiledTrajectory::compile(points, type), on_progress);
+}
+
+TrajectoryResult HIWINDriver::writeTrajectory(const CompiledTrajectory& trajectory,
+                                              const TrajectoryProgressCallback& on_progress)
+{
+  const size_t total = trajectory.frames.size();
+  const size_t window = trajectory_window_;
+  const double lookahead = trajectory_lookahead_;
+  TrajectoryResult result = { 0, 0, total };
+
+  TrajectoryViolation violation;
+  if (!checkTrajectory(trajectory.points, trajectory.type, violation))
+  {
+    std::cout << "Trajectory point " << violation.index << " breaks limit " << static_cast<int>(violation.violation)
+              << " of axis " << violation.axis << std::endl;
+    result.result = LIMIT_VIOLATION;
+    result.failed_index = violation.index;
+    return result;
+  }
+
+  // Points written together share one future; the result of each lands in results
+  struct Batch
+  {
+    std::future<int> done;
+    size_t begin;
+    size_t count;
+  };
+  std::deque<Batch> in_flight;
+  size_t in_flight_points = 0;
+  std::vector<int> results(total, 0);
+
+  // Motion time sent so far and the part of it the controller should have executed by now
+  double sent_time = 0.0;
+  double executed_time = 0.0;
+  bool started = false;
+  std::chrono::steady_clock::time_point last_poll;
+
+  size_t next = 0;
+  std::future<int> abort;
+
+  // Waits for the oldest unacknowledged batch, returns false once a point has failed
+  auto acknowledge = [&]() {
+    Batch& batch = in_flight.front();
+    batch.done.wait();
+    for (size_t i = batch.begin; i < batch.begin + batch.count && result.result == 0; i++)
+    {
+      if (results[i] != 0)
+      {
+        result.result = results[i];
+        result.failed_index = i;
+
+        // The points sent behind it may be accepted and would run with this one missing
+        if (next > i + 1)
+        {
+          abort = commander_->motionAbortAsync();
+        }
+        break;
+      }
+
+      result.acknowledged++;
+      if (!started)
+      {
+        started = true;
+        last_poll = std::chrono::steady_clock::now();
+      }
+      if (on_progress)
+      {
+        on_progress(result.acknowledged, total);
+      }
+    }
+    in_flight_points -= batch.count;
+    in_flight.pop_front();
+    return result.result == 0;
+  };
+
+  while (next < total && result.result == 0)
+  {
+    while (in_flight_points >= window && acknowledge())
+    {
+    }
+
+    while (result.result == 0 && started && sent_time - executed_time > lookahead)
+    {
+      std::this_thread::sleep_for(TRAJECTORY_POLL_PERIOD);
+
+      MotionStatus status;
+      int poll_result = commander_->getMotionState(status);
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (poll_result != 0 || status == MotionStatus::ServerOff)
+      {
+        result.result = poll_result != 0 ? poll_result : MOTION_STOPPED;
+        result.failed_index = next;
+      }
+      else if (status != MotionStatus::Hold)
+      {
+        executed_time += std::chrono::duration<double>(now - last_poll).count();
+      }
+      last_poll = now;
+    }
+    if (result.result != 0)
+    {
+      break;
+    }
+
+    // Take as many points as the window and the lookahead allow, so they go out in one write
+    size_t count = 0;
+    do
+    {
+      sent_time += trajectory.points[next + count].goal_time;
+      count++;
+    } while (next + count < total && in_flight_points + count < window &&
+             !(started && sent_time - executed_time > lookahead));
+
+    in_flight.push_back(Batch{ commander_->sendFramesAsync(&trajectory.frames[next], count, &results[next]), next,
+                               count });
+    in_flight_points += count;
+    next += count;
+  }
+
+  // Collect the remaining acknowledgements, also after a failure so no response is left behind
+  while (!in_flight.empty())
+  {
+    acknowledge();
+  }
+  if (abort.valid() && abort.get() != 0)
+  {
+    std::cout << "Failed to abort the motion after trajectory point " << result.failed_index << std::endl;
+  }
+  return result;
+}
+
+void HIWINDriver::setTrajectoryStreaming(size_t window, double lookahead)
+{
+  trajectory_window_ = std::max<size_t>(window, 1);
+  trajectory_lookahead_ = lookahead;
+}
+
+bool HIWINDriver::setJointLimits(const JointLimits& limits)
+{
+  if (limits.axis_count > TRAJECTORY_MAX_AXES)
+  {
+    return false;
+  }
+  joint_limits_ = limits;
+  return true;
+}
+
+bool HIWINDriver::checkTrajectory(const std::vector<TrajectoryPoint>& points, TrajectoryType type,
+                                  TrajectoryViolation& violation) const
+{
+  if (joint_limits_.axis_count == 0)
+  {
+    violation.violation = LimitViolation::None;
+    violation.index = points.size();
+    violation.axis = 0;
+    return true;
+  }
+
+  TrajectoryBuffer buffer;
+  buffer.fromPoints(points, joint_limits_.axis_count);
+  return validateTrajectory(buffer, type, joint_limits_, violation);
+}
+
 void HIWINDriver::motionAbort()
 {
   commander_->motionAbort();
@@ -0,0 +1,277 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+
+#include <hiwin_robot_client_library/online_trajectory.hpp>
+
+namespace hrsdk
+{
+// Bisection steps for the braking jerk, narrowing it to 2^-32 of the jerk range
+static const int BRAKING_ITERATIONS = 32;
+
+// Share of the jerk limit below which what is left of a landing counts as rounding error
+static const double LANDING_TOLERANCE = 1e-9;
+
+/*
+ * Distance an axis at \p velocity and \p acceleration covers forwards while it brakes to a stop as
+ * hard as the limits allow: the acceleration ramps down to -a_p, holds at -A if a_p
+ * reaches it, and ramps back to zero just as the velocity does.
+ */
+static double stoppingDistance(double velocity, double acceleration, double max_acceleration, double max_jerk)
+{
+  // Never moves forwards again if even full negative jerk keeps the velocity at or below zero
+  const double j = max_jerk;
+  if (velocity + std::max(acceleration, 0.0) * acceleration / (2 * j) <= 0)
+  {
+    return 0;
+  }
+
+  if (acceleration < 0 && acceleration * acceleration > 2 * j * velocity)
+  {
+    // Already braking harder than needed: ramping the acceleration back to zero stops it early
+    const double t = (-acceleration - std::sqrt(acceleration * acceleration - 2 * j * velocity)) / j;
+    return t * (velocity + t * (acceleration / 2 + t * j / 6));
+  }
+
+  double peak = std::sqrt(j * velocity + acceleration * acceleration / 2);
+  double hold = 0;
+  if (peak > max_acceleration)
+  {
+    peak = max_acceleration;
+    hold = (velocity + acceleration * acceleration / (2 * j) - peak * peak / j) / peak;
+  }
+
+  const double t1 = (acceleration + peak) / j;
+  double distance = t1 * (velocity + t1 * (acceleration / 2 - t1 * j / 6));
+  const double v1 = velocity + t1 * (acceleration - t1 * j / 2);
+  distance += hold * (v1 - hold * peak / 2);
+  const double v2 = v1 - hold * peak;
+  const double t3 = peak / j;
+  return distance + t3 * (v2 + t3 * (-peak / 2 + t3 * j / 6));
+}
+
+// Moves (position, velocity, acceleration) by dt at constant jerk
+static void integrate(double& position, double& velocity, double& acceleration, double jerk, double dt)
+{
+  position += dt * (velocity + dt * (acceleration / 2 + dt * jerk / 6));
+  velocity += dt * (acceleration + dt * jerk / 2);
+  acceleration += dt * jerk;
+}
+
+/*
+ * Moves one axis by one cycle at constant jerk, in a frame where the target lies ahead. The jerk
+ * first steers towards the velocity limit, aiming at the acceleration from which ramping back to
+ * zero just reaches it. If after such a cycle the axis could no longer stop at the target, or
+ * ramping its acceleration back to zero would pass the velocity limit, the largest jerk that
+ * keeps both is found by bisection; both grow with the jerk.
+ */
+static void stepAxis(double& position, double& velocity, double& acceleration, double target, double max_velocity,
+                     double max_acceleration, double max_jerk, double dt)
+{
+  const double direction = target >= position ? 1.0 : -1.0;
+  const double distance = direction * (target - position);
+  const double v = direction * velocity;
+  const double a = direction * acceleration;
+
+  // Velocity error counted from where the velocity ends up once the acceleration is back at zero,
+  // one cycle ahead
+  const double v_next = v + a * dt;
+  const double velocity_error = max_velocity - (v_next + a * std::fabs(a) / (2 * max_jerk));
+  double wanted = std::min(max_acceleration, std::sqrt(2 * max_jerk * std::fabs(velocity_error)));
+  wanted = velocity_error >= 0 ? wanted : -wanted;
+  double jerk = std::max(-max_jerk, std::min((wanted - a) / dt, max_jerk));
+
+  auto fits = [&](double j) {
+    double p = 0, v1 = v, a1 = a;
+    integrate(p, v1, a1, j, dt);
+
+    // The velocity peaks within the cycle if the acceleration drops through zero there, and the
+    // next cycle can take the acceleration back down no faster than the acceleration limit lets
+    // its constant jerk run for a whole cycle
+    const double turn = j < 0 ? -a / j : 0;
+    const double peak = turn > 0 && turn < dt ? v + a * turn / 2 : v1;
+    const double next_jerk = std::min(max_jerk, (max_acceleration + a1) / dt);
+    return p + stoppingDistance(v1, a1, max_acceleration, max_jerk) <= distance &&
+           v1 + std::max(a1, 0.0) * a1 / (2 * next_jerk) <= max_velocity && peak <= max_velocity;
+  };
+
+  if (!fits(jerk))
+  {
+    double low = std::max(-max_jerk, (-max_acceleration - a) / dt);
+    double high = jerk;
+    for (int i = 0; i < BRAKING_ITERATIONS; i++)
+    {
+      double middle = 0.5 * (low + high);
+      if (fits(middle))
+      {
+        low = middle;
+      }
+      else
+      {
+        high = middle;
+      }
+    }
+    jerk = low;
+  }
+
+  jerk *= direction;
+  integrate(position, velocity, acceleration, jerk, dt);
+}
+
+/*
+ * Jerks of the three cycles that bring an axis exactly to rest at \p target. Each cycle adds a
+ * known amount of position, velocity and acceleration per unit of jerk, so three of them can
+ * match all three; the factors below invert that system for cycles of unit length.
+ */
+static void landingJerks(double position, double velocity, double acceleration, double target, double dt,
+                         double (&jerks)[3])
+{
+  // What the cycles have to add on top of coasting at constant acceleration, in units of dt
+  const double p = (target - position - 3 * dt * (velocity + 1.5 * dt * acceleration)) / (dt * dt * dt);
+  const double v = -(velocity + 3 * dt * acceleration) / (dt * dt);
+  const double a = -acceleration / dt;
+
+  jerks[0] = p - v + a / 3;
+  jerks[1] = -2 * p + 3 * v - 7 * a / 6;
+  jerks[2] = p - 2 * v + 11 * a / 6;
+}
+
+// Whether the landing keeps within the limits, the velocity included where it turns within a cycle
+static bool landingFits(double velocity, double acceleration, const double (&jerks)[3], double max_velocity,
+                        double max_acceleration, double max_jerk, double dt)
+{
+  double position = 0;
+  for (double jerk : jerks)
+  {
+    if (std::fabs(jerk) > max_jerk)
+    {
+      return false;
+    }
+    if (jerk != 0 && -acceleration / jerk > 0 && -acceleration / jerk < dt &&
+        std::fabs(velocity - acceleration * acceleration / (2 * jerk)) > max_velocity)
+    {
+      return false;
+    }
+    integrate(position, velocity, acceleration, jerk, dt);
+    if (std::fabs(velocity) > max_velocity || std::fabs(acceleration) > max_acceleration)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+OnlineTrajectoryGenerator::OnlineTrajectoryGenerator(const JointLimits& limits, double cycle_time)
+  : limits_(limits)
+  , cycle_time_(cycle_time)
+  , state_()
+  , target_()
+  , settled_(true)
+{
+  // Every per-axis array holds TRAJECTORY_MAX_AXES entries
+  limits_.axis_count = std::min(limits_.axis_count, TRAJECTORY_MAX_AXES);
+}
+
+void OnlineTrajectoryGenerator::reset(const TrajectoryPoint& state)
+{
+  state_ = state;
+  state_.goal_time = cycle_time_;
+  std::copy(state.positions, state.positions + limits_.axis_count, target_);
+
+  // Already at the target; only an axis still moving has to be brought to rest
+  settled_ = true;
+  for (size_t axis = 0; axis < limits_.axis_count; axis++)
+  {
+    settled_ = settled_ && state.velocities[axis] == 0 && state.accelerations[axis] == 0;
+  }
+}
+
+void OnlineTrajectoryGenerator::setTarget(const double* positions)
+{
+  std::copy(positions, positions + limits_.axis_count, target_);
+  settled_ = false;
+}
+
+bool OnlineTrajectoryGenerator::update(TrajectoryPoint& next)
+{
+  if (settled_)
+  {
+    return false;
+  }
+
+  settled_ = true;
+  for (size_t axis = 0; axis < limits_.axis_count; axis++)
+  {
+    double& position = state_.positions[axis];
+    double& velocity = state_.velocities[axis];
+    double& acceleration = state_.accelerations[axis];
+    const double max_jerk = limits_.max_jerk[axis];
+
+    // Once three cycles can land the axis exactly at rest on its target within the limits, it
+    // follows them; the plan solved in the next cycle is the remainder of this one
+    double jerks[3];
+    landingJerks(position, velocity, acceleration, target_[axis], cycle_time_, jerks);
+    if (landingFits(velocity, acceleration, jerks, limits_.max_velocity[axis], limits_.max_acceleration[axis],
+                    max_jerk, cycle_time_))
+    {
+      integrate(position, velocity, acceleration, jerks[0], cycle_time_);
+      if (std::fabs(jerks[1]) <= LANDING_TOLERANCE * max_jerk && std::fabs(jerks[2]) <= LANDING_TOLERANCE * max_jerk)
+      {
+        position = target_[axis];
+        velocity = 0;
+        acceleration = 0;
+      }
+      else
+      {
+        settled_ = false;
+      }
+      continue;
+    }
+
+    stepAxis(position, velocity, acceleration, target_[axis], limits_.max_velocity[axis],
+             limits_.max_acceleration[axis], max_jerk, cycle_time_);
+    settled_ = false;
+  }
+
+  next = state_;
+  return true;
+}
+
+const TrajectoryPoint& OnlineTrajectoryGenerator::getState() const
+{
+  return state_;
+}
+
+bool OnlineTrajectoryGenerator::isSettled() const
+{
+  return settled_;
+}
+
+}  // namespace hrsdk
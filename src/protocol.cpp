@@ -0,0 +1,192 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <cstdio>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <hiwin_robot_client_library/protocol.hpp>
+
+namespace hrsdk
+{
+namespace protocol
+{
+// Above this printf's output no longer fits the 64 bit fixed-point path below
+static const double FIXED7_FAST_LIMIT = 1e11;
+static const uint64_t FIXED7_SCALE = 10000000;
+
+size_t formatFixed7(double value, char* buffer)
+{
+  const double magnitude = std::fabs(value);
+  if (!(magnitude < FIXED7_FAST_LIMIT))
+  {
+    // Huge, infinite or NaN; never a joint angle, so the slow path is fine
+    return static_cast<size_t>(snprintf(buffer, FIXED7_BUFFER_SIZE, "%.7f", value));
+  }
+
+  // Round magnitude * 10^7 to an integer exactly as printf does, i.e. to nearest with ties to
+  // even. Everything below 1e-8 rounds to zero.
+  uint64_t scaled = 0;
+  if (magnitude >= 1e-8)
+  {
+    int exponent;
+    const uint64_t mantissa = static_cast<uint64_t>(std::ldexp(std::frexp(magnitude, &exponent), 53));
+    const int shift = 53 - exponent;  // 16 to 79 for the range handled here
+
+    // mantissa * 10^7 needs up to 77 bits, kept as two 64 bit halves
+    const uint64_t low_part = (mantissa & 0xFFFFFFFF) * FIXED7_SCALE;
+    const uint64_t high_part = (mantissa >> 32) * FIXED7_SCALE;
+    const uint64_t lo = low_part + (high_part << 32);
+    const uint64_t hi = (high_part >> 32) + (lo < low_part ? 1 : 0);
+
+    // Split the product at the binary point into scaled and the remainder, and find one half
+    uint64_t rem_hi, rem_lo, half_hi, half_lo;
+    if (shift < 64)
+    {
+      scaled = (lo >> shift) | (hi << (64 - shift));
+      rem_hi = 0;
+      rem_lo = lo & ((uint64_t(1) << shift) - 1);
+      half_hi = 0;
+      half_lo = uint64_t(1) << (shift - 1);
+    }
+    else
+    {
+      scaled = hi >> (shift - 64);
+      rem_hi = hi & ((uint64_t(1) << (shift - 64)) - 1);
+      rem_lo = lo;
+      half_hi = shift == 64 ? 0 : uint64_t(1) << (shift - 65);
+      half_lo = shift == 64 ? uint64_t(1) << 63 : 0;
+    }
+
+    const bool tie = rem_hi == half_hi && rem_lo == half_lo;
+    const bool above = rem_hi > half_hi || (rem_hi == half_hi && rem_lo > half_lo);
+    if (above || (tie && (scaled & 1)))
+    {
+      scaled++;
+    }
+  }
+
+  char* it = buffer;
+  if (std::signbit(value))
+  {
+    *it++ = '-';
+  }
+
+  uint64_t integer = scaled / FIXED7_SCALE;
+  uint64_t fraction = scaled % FIXED7_SCALE;
+
+  char digits[20];
+  size_t count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + integer % 10);
+    integer /= 10;
+  } while (integer != 0);
+  while (count > 0)
+  {
+    *it++ = digits[--count];
+  }
+
+  *it++ = '.';
+  for (int i = 6; i >= 0; i--)
+  {
+    it[i] = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  it += 7;
+
+  return static_cast<size_t>(it - buffer);
+}
+
+void toMilliDegrees(const double* radians, int32_t* millidegrees, size_t count)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128d to_degrees = _mm_set1_pd(180 / M_PI);
+  const __m128d thousand = _mm_set1_pd(1000.0);
+  const __m128d sign_bit = _mm_set1_pd(-0.0);
+  const __m128d half = _mm_set1_pd(0.5);
+  const __m128d int32_limit = _mm_set1_pd(2147483647.0);
+
+  for (; i + 2 <= count; i += 2)
+  {
+    // Same operations in the same order as the scalar version, so the products are identical
+    const __m128d value = _mm_mul_pd(_mm_mul_pd(_mm_loadu_pd(radians + i), to_degrees), thousand);
+
+    // NaN and values beyond int32 go through the scalar conversion to match it exactly
+    if (_mm_movemask_pd(_mm_cmplt_pd(_mm_andnot_pd(sign_bit, value), int32_limit)) != 3)
+    {
+      millidegrees[i] = toMilliDegrees(radians[i]);
+      millidegrees[i + 1] = toMilliDegrees(radians[i + 1]);
+      continue;
+    }
+
+    // std::round without SSE4.1: truncate, then step away from zero where the dropped fraction,
+    // which the subtraction gives exactly, is at least one half
+    const __m128i truncated = _mm_cvttpd_epi32(value);
+    const __m128d fraction = _mm_andnot_pd(sign_bit, _mm_sub_pd(value, _mm_cvtepi32_pd(truncated)));
+    const __m128i round_up = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpge_pd(fraction, half)), _MM_SHUFFLE(3, 3, 2, 0));
+    const __m128i negative = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmplt_pd(value, _mm_setzero_pd())),
+                                               _MM_SHUFFLE(3, 3, 2, 0));
+
+    // Masks are -1 where set: add them for negative values, subtract them for positive ones
+    const __m128i rounded = _mm_sub_epi32(_mm_add_epi32(truncated, _mm_and_si128(round_up, negative)),
+                                          _mm_andnot_si128(negative, round_up));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(millidegrees + i), rounded);
+  }
+#endif
+  for (; i < count; i++)
+  {
+    millidegrees[i] = toMilliDegrees(radians[i]);
+  }
+}
+
+void fromMilliDegrees(const int32_t* millidegrees, double* radians, size_t count)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128d thousand = _mm_set1_pd(1000.0);
+  const __m128d to_radians = _mm_set1_pd(M_PI / 180);
+
+  for (; i + 2 <= count; i += 2)
+  {
+    const __m128d value = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(millidegrees + i)));
+    _mm_storeu_pd(radians + i, _mm_mul_pd(_mm_div_pd(value, thousand), to_radians));
+  }
+#endif
+  for (; i < count; i++)
+  {
+    radians[i] = fromMilliDegrees(millidegrees[i]);
+  }
+}
+
+}  // namespace protocol
+}  // namespace hrsdk
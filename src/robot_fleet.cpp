@@ -0,0 +1,140 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <future>
+
+#include <hiwin_robot_client_library/robot_fleet.hpp>
+
+namespace hrsdk
+{
+RobotFleet::RobotFleet(size_t reactor_threads, bool busy_poll)
+{
+  for (size_t i = 0; i < std::max<size_t>(reactor_threads, 1); i++)
+  {
+    reactors_.emplace_back(new socket::Reactor(busy_poll));
+    reactors_.back()->start();
+  }
+}
+
+RobotFleet::~RobotFleet()
+{
+  disconnectAll();
+  robots_.clear();
+}
+
+size_t RobotFleet::addRobot(const std::string& robot_ip, int command_port, int event_port, int file_port)
+{
+  Member member;
+  member.driver.reset(new HIWINDriver(robot_ip));
+  member.driver->setReactor(reactors_[robots_.size() % reactors_.size()].get());
+  member.command_port = command_port;
+  member.event_port = event_port;
+  member.file_port = file_port;
+
+  robots_.push_back(std::move(member));
+  return robots_.size() - 1;
+}
+
+size_t RobotFleet::size() const
+{
+  return robots_.size();
+}
+
+size_t RobotFleet::reactorCount() const
+{
+  return reactors_.size();
+}
+
+HIWINDriver& RobotFleet::robot(size_t index)
+{
+  return *robots_[index].driver;
+}
+
+size_t RobotFleet::connectAll(std::chrono::milliseconds timeout)
+{
+  // Every socket of every robot is dialled at once, so unreachable robots cost one timeout in total
+  std::vector<socket::TCPClient*> clients;
+  for (size_t i = 0; i < robots_.size(); i++)
+  {
+    Member& member = robots_[i];
+    member.driver->beginConnect(member.command_port, member.event_port, member.file_port, clients);
+  }
+  socket::TCPClient::connectAll(clients.data(), clients.size(), timeout);
+
+  size_t connected = 0;
+  for (size_t i = 0; i < robots_.size(); i++)
+  {
+    if (robots_[i].driver->finishConnect())
+    {
+      connected++;
+    }
+  }
+  return connected;
+}
+
+void RobotFleet::disconnectAll()
+{
+  for (size_t i = 0; i < robots_.size(); i++)
+  {
+    robots_[i].driver->disconnect();
+  }
+}
+
+size_t RobotFleet::readStates(std::vector<RobotStateSnapshot>& states, size_t axis_count)
+{
+  states.resize(robots_.size());
+
+  std::vector<std::future<bool>> replies;
+  replies.reserve(robots_.size());
+  for (size_t i = 0; i < robots_.size(); i++)
+  {
+    replies.push_back(robots_[i].driver->readStateAsync(states[i], axis_count));
+  }
+
+  size_t valid = 0;
+  for (size_t i = 0; i < replies.size(); i++)
+  {
+    if (replies[i].get())
+    {
+      valid++;
+    }
+  }
+  return valid;
+}
+
+void RobotFleet::getLatencyStats(std::vector<LatencyStats>& stats)
+{
+  stats.resize(robots_.size());
+  for (size_t i = 0; i < robots_.size(); i++)
+  {
+    stats[i] = robots_[i].driver->getLatencyStats();
+  }
+}
+
+}  // namespace hrsdk
@@ -0,0 +1,184 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+
+#include <hiwin_robot_client_library/socket/reactor.hpp>
+
+namespace hrsdk
+{
+namespace socket
+{
+
+Reactor::Reactor(bool busy_poll)
+  : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC))
+  , wake_fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+  , busy_poll_(busy_poll)
+  , running_(false)
+  , next_token_(1)
+{
+  // The wake-up event carries token 0, which is how run() tells it apart
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.u64 = 0;
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+Reactor::~Reactor()
+{
+  stop();
+  ::close(wake_fd_);
+  ::close(epoll_fd_);
+}
+
+bool Reactor::start()
+{
+  if (running_ || epoll_fd_ < 0 || wake_fd_ < 0)
+  {
+    return false;
+  }
+
+  running_ = true;
+  thread_ = std::thread(&Reactor::run, this);
+  return true;
+}
+
+void Reactor::stop()
+{
+  running_ = false;
+
+  uint64_t one = 1;
+  ssize_t res = ::write(wake_fd_, &one, sizeof(one));
+  (void)res;
+
+  if (thread_.joinable())
+  {
+    thread_.join();
+  }
+}
+
+bool Reactor::isRunning() const
+{
+  return running_;
+}
+
+bool Reactor::add(TCPClient* client)
+{
+  std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+
+  // A fresh token per registration, so events left over from an earlier one never reach a new
+  // client that happens to live at the same address
+  epoll_event event = {};
+  event.events = EPOLLIN | EPOLLRDHUP;
+  event.data.u64 = next_token_;
+
+  if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client->getSocketFd(), &event) != 0)
+  {
+    std::cout << "Failed to register socket with the reactor." << std::endl;
+    return false;
+  }
+  clients_[next_token_++] = client;
+  return true;
+}
+
+void Reactor::remove(TCPClient* client)
+{
+  ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->getSocketFd(), nullptr);
+
+  // Waits out a dispatch in progress. Events epoll_wait() already returned for this client are
+  // dropped by run() once the token is gone.
+  std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+  for (std::map<uint64_t, TCPClient*>::iterator it = clients_.begin(); it != clients_.end();)
+  {
+    if (it->second == client)
+    {
+      it = clients_.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void Reactor::run()
+{
+  epoll_event events[MAX_EVENTS];
+  const int timeout = busy_poll_ ? 0 : -1;
+
+  while (running_)
+  {
+    int count = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+    if (count < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      std::cout << "Reactor stopped, epoll_wait failed." << std::endl;
+      break;
+    }
+    if (count == 0)
+    {
+      continue;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(dispatch_mutex_);
+    for (int i = 0; i < count; i++)
+    {
+      if (events[i].data.u64 == 0)
+      {
+        uint64_t value;
+        ssize_t res = ::read(wake_fd_, &value, sizeof(value));
+        (void)res;
+        continue;
+      }
+
+      std::map<uint64_t, TCPClient*>::const_iterator it = clients_.find(events[i].data.u64);
+      if (it == clients_.end())
+      {
+        continue;
+      }
+      TCPClient* client = it->second;
+
+      client->onReadable();
+
+      // A closed connection stays readable forever; stop watching it
+      if (client->getState() != SocketState::Connected)
+      {
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, client->getSocketFd(), nullptr);
+      }
+    }
+  }
+}
+
+}  // namespace socket
+}  // namespace hrsdk
@@ -21,9 +21,13 @@
  */
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <endian.h>
 #include <netinet/tcp.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstring>
 #include <sstream>
@@ -37,7 +41,15 @@ namespace hrsdk
 namespace socket
 {
 
-TCPClient::TCPClient() : socket_fd_(-1), state_(SocketState::Invalid), reconnection_time_(std::chrono::seconds(10))
+constexpr size_t TCPClient::RECEIVE_BUFFER_SIZE;
+
+TCPClient::TCPClient()
+  : socket_fd_(-1)
+  , state_(SocketState::Invalid)
+  , reconnection_time_(std::chrono::seconds(10))
+  , recv_buffer_(RECEIVE_BUFFER_SIZE)
+  , recv_begin_(0)
+  , recv_end_(0)
 {
 }
 
@@ -58,6 +70,12 @@ void TCPClient::setupOptions()
   }
 }
 
+void TCPClient::resetReceiveBuffer()
+{
+  recv_begin_ = 0;
+  recv_end_ = 0;
+}
+
 bool TCPClient::setup(const std::string& ip_addr, const int port, const size_t max_num_tries,
                       const std::chrono::milliseconds reconnection_time)
 {
@@ -103,11 +121,147 @@ bool TCPClient::setup(const std::string& ip_addr, const int port, const size_t m
     }
   }
   setupOptions();
+  resetReceiveBuffer();
   state_ = SocketState::Connected;
   std::cout << "Connection established for " << ip_addr << ":" << std::dec << port << std::endl;
   return connected;
 }
 
+bool TCPClient::beginConnect(const std::string& ip_addr, const int port)
+{
+  if (state_ == SocketState::Connected)
+    return false;
+
+  sockaddr_in server_addr;
+  server_addr.sin_family = AF_INET;
+  server_addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, ip_addr.c_str(), &server_addr.sin_addr) != 1)
+  {
+    std::cout << "Invalid robot address " << ip_addr << std::endl;
+    state_ = SocketState::Invalid;
+    return false;
+  }
+
+  socket_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (socket_fd_ == -1 || (!open(socket_fd_, (sockaddr*)&server_addr, sizeof(server_addr)) && errno != EINPROGRESS))
+  {
+    std::cout << "Failed to connect to " << ip_addr << ":" << port << ": " << std::strerror(errno) << std::endl;
+    close();
+    state_ = SocketState::Invalid;
+    return false;
+  }
+
+  state_ = SocketState::Connecting;
+  return true;
+}
+
+bool TCPClient::finishConnect()
+{
+  int error = 0;
+  socklen_t error_len = sizeof(error);
+  if (::getsockopt(socket_fd_, SOL_SOCKET, SO_ERROR, &error, &error_len) != 0)
+  {
+    error = errno;
+  }
+
+  sockaddr_in peer;
+  socklen_t peer_len = sizeof(peer);
+  if (error == 0 && ::getpeername(socket_fd_, (sockaddr*)&peer, &peer_len) != 0)
+  {
+    error = errno;
+  }
+
+  if (error != 0)
+  {
+    std::cout << "Failed to connect to robot: " << std::strerror(error) << std::endl;
+    close();
+    state_ = SocketState::Invalid;
+    return false;
+  }
+
+  ::fcntl(socket_fd_, F_SETFL, ::fcntl(socket_fd_, F_GETFL) & ~O_NONBLOCK);
+  setupOptions();
+  resetReceiveBuffer();
+  state_ = SocketState::Connected;
+
+  char address[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+  std::cout << "Connection established for " << address << ":" << ntohs(peer.sin_port) << std::endl;
+
+  if (!onConnected())
+  {
+    close();
+    state_ = SocketState::Invalid;
+    return false;
+  }
+  return true;
+}
+
+bool TCPClient::connectAll(TCPClient* const* clients, size_t count, std::chrono::milliseconds timeout)
+{
+  const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+
+  std::vector<pollfd> fds;
+  std::vector<TCPClient*> waiting;
+  while (true)
+  {
+    fds.clear();
+    waiting.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+      if (clients[i]->state_ == SocketState::Connecting)
+      {
+        pollfd fd = { clients[i]->socket_fd_, POLLOUT, 0 };
+        fds.push_back(fd);
+        waiting.push_back(clients[i]);
+      }
+    }
+    if (waiting.empty())
+    {
+      break;
+    }
+
+    std::chrono::milliseconds remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    int ready = remaining.count() > 0 ? ::poll(fds.data(), fds.size(), static_cast<int>(remaining.count())) : 0;
+    if (ready < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (ready <= 0)
+    {
+      for (size_t i = 0; i < waiting.size(); i++)
+      {
+        std::cout << "Connection attempt timed out after " << timeout.count() << " ms" << std::endl;
+        waiting[i]->close();
+        waiting[i]->state_ = SocketState::Invalid;
+      }
+      break;
+    }
+
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+      if (fds[i].revents != 0)
+      {
+        waiting[i]->finishConnect();
+      }
+    }
+  }
+
+  bool connected = true;
+  for (size_t i = 0; i < count; i++)
+  {
+    connected = connected && clients[i]->state_ == SocketState::Connected;
+  }
+  return connected;
+}
+
+bool TCPClient::onConnected()
+{
+  return true;
+}
+
 void TCPClient::close()
 {
   if (socket_fd_ >= 0)
@@ -116,6 +270,15 @@ void TCPClient::close()
     ::close(socket_fd_);
     socket_fd_ = -1;
   }
+  resetReceiveBuffer();
+}
+
+void TCPClient::shutdown()
+{
+  if (socket_fd_ >= 0)
+  {
+    ::shutdown(socket_fd_, SHUT_RDWR);
+  }
 }
 
 void TCPClient::setReceiveTimeout(const timeval& timeout)
@@ -135,6 +298,15 @@ bool TCPClient::read(uint8_t* buf, const size_t buf_len, size_t& read)
   if (state_ != SocketState::Connected)
     return false;
 
+  // Hand out bytes left over from a framed read first, so both readers see one stream
+  if (recv_end_ > recv_begin_)
+  {
+    read = std::min(buf_len, recv_end_ - recv_begin_);
+    std::memcpy(buf, &recv_buffer_[recv_begin_], read);
+    recv_begin_ += read;
+    return true;
+  }
+
   ssize_t res = ::recv(socket_fd_, buf, buf_len, 0);
 
   if (res == 0)
@@ -149,6 +321,127 @@ bool TCPClient::read(uint8_t* buf, const size_t buf_len, size_t& read)
   return true;
 }
 
+ssize_t TCPClient::fillReceiveBuffer(int flags)
+{
+  if (recv_end_ == recv_buffer_.size())
+  {
+    if (recv_begin_ > 0)
+    {
+      // Move the unconsumed bytes to the front so more fit behind them
+      std::memmove(&recv_buffer_[0], &recv_buffer_[recv_begin_], recv_end_ - recv_begin_);
+      recv_end_ -= recv_begin_;
+      recv_begin_ = 0;
+    }
+    else
+    {
+      recv_buffer_.resize(recv_buffer_.size() * 2);
+    }
+  }
+
+  while (true)
+  {
+    ssize_t res = ::recv(socket_fd_, &recv_buffer_[recv_end_], recv_buffer_.size() - recv_end_, flags);
+
+    if (res > 0)
+    {
+      recv_end_ += static_cast<size_t>(res);
+      return res;
+    }
+    else if (res == 0)
+    {
+      state_ = SocketState::Disconnected;
+      return -1;
+    }
+    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+      return 0;
+    }
+    else if (errno != EINTR)
+    {
+      state_ = SocketState::Disconnected;
+      return -1;
+    }
+  }
+}
+
+bool TCPClient::readFrame(uint8_t* buf, const size_t frame_len)
+{
+  if (state_ != SocketState::Connected)
+    return false;
+
+  if (recv_buffer_.size() < frame_len)
+  {
+    recv_buffer_.resize(frame_len);
+  }
+
+  while (!takeFrame(buf, frame_len))
+  {
+    if (fillReceiveBuffer(0) <= 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TCPClient::receiveAvailable()
+{
+  if (state_ != SocketState::Connected)
+    return false;
+
+  ssize_t res;
+  do
+  {
+    res = fillReceiveBuffer(MSG_DONTWAIT);
+  } while (res > 0);
+
+  return res == 0;
+}
+
+bool TCPClient::takeFrame(uint8_t* buf, const size_t frame_len)
+{
+  if (recv_end_ - recv_begin_ < frame_len)
+  {
+    return false;
+  }
+
+  std::memcpy(buf, &recv_buffer_[recv_begin_], frame_len);
+  recv_begin_ += frame_len;
+  if (recv_begin_ == recv_end_)
+  {
+    resetReceiveBuffer();
+  }
+  return true;
+}
+
+size_t TCPClient::receiveBuffered() const
+{
+  return recv_end_ - recv_begin_;
+}
+
+void TCPClient::onReadable()
+{
+  receiveAvailable();
+}
+
+void TCPClient::unread(const uint8_t* buf, const size_t len)
+{
+  if (recv_begin_ < len)
+  {
+    size_t pending = recv_end_ - recv_begin_;
+    if (recv_buffer_.size() < pending + len)
+    {
+      recv_buffer_.resize(pending + len);
+    }
+    std::memmove(&recv_buffer_[len], &recv_buffer_[recv_begin_], pending);
+    recv_begin_ = len;
+    recv_end_ = len + pending;
+  }
+
+  recv_begin_ -= len;
+  std::memcpy(&recv_buffer_[recv_begin_], buf, len);
+}
+
 bool TCPClient::write(const uint8_t* buf, const size_t buf_len, size_t& written)
 {
   written = 0;
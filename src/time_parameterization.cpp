@@ -0,0 +1,765 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <hiwin_robot_client_library/time_parameterization.hpp>
+
+namespace hrsdk
+{
+// Rounds of slowing the path down where it breaks a limit, before the best one is stretched to fit
+static const int MAX_STRETCH_ROUNDS = 4;
+
+// Tolerance on the limits when deciding whether a segment still needs stretching
+static const double STRETCH_TOLERANCE = 1e-9;
+
+// Newton steps allowed when polishing a velocity peak, each halving the bracket at worst
+static const int PEAK_ITERATIONS = 64;
+
+// Goal times go out in whole milliseconds, see protocol::Milli
+static const double TIME_RESOLUTION = 0.001;
+
+// Share of a millisecond a goal time may exceed it by and still round down
+static const double QUANTIZE_TOLERANCE = 1e-6;
+
+// Rounds of searching the stretch of the quantized timing, and how close the search gets to the
+// shortest stretch that fits before it stops
+static const int MAX_QUANTIZE_ROUNDS = 16;
+static const double QUANTIZE_SEARCH_TOLERANCE = 0.01;
+
+// Peaks of the quintic rest-to-rest profile over distance d in time T: v = 1.875 d/T,
+// a = 5.7735 d/T^2, j = 60 d/T^3
+static const double REST_PEAK_VELOCITY = 1.875;
+static const double REST_PEAK_ACCELERATION = 5.7735026919;
+static const double REST_PEAK_JERK = 60.0;
+
+// Coefficients of the quintic from (p0, v0, a0) to (p1, v1, a1) in time t, lowest order first
+static void quinticCoefficients(double p0, double v0, double a0, double p1, double v1, double a1, double t,
+                                double (&c)[6])
+{
+  const double h = p1 - p0;
+  const double t2 = t * t;
+  const double t3 = t2 * t;
+
+  c[0] = p0;
+  c[1] = v0;
+  c[2] = 0.5 * a0;
+  c[3] = (20 * h - (8 * v1 + 12 * v0) * t - (3 * a0 - a1) * t2) / (2 * t3);
+  c[4] = (-30 * h + (14 * v1 + 16 * v0) * t + (3 * a0 - 2 * a1) * t2) / (2 * t3 * t);
+  c[5] = (12 * h - 6 * (v1 + v0) * t + (a1 - a0) * t2) / (2 * t3 * t2);
+}
+
+static double velocity(const double (&c)[6], double t)
+{
+  return c[1] + t * (2 * c[2] + t * (3 * c[3] + t * (4 * c[4] + t * 5 * c[5])));
+}
+
+static double acceleration(const double (&c)[6], double t)
+{
+  return 2 * c[2] + t * (6 * c[3] + t * (12 * c[4] + t * 20 * c[5]));
+}
+
+static double jerk(const double (&c)[6], double t)
+{
+  return 6 * c[3] + t * (24 * c[4] + t * 60 * c[5]);
+}
+
+/*
+ * Root of the acceleration in [lo, hi], where it is monotonic and changes sign. Newton steps that
+ * leave the bracket are replaced by bisection.
+ */
+static double accelerationRoot(const double (&c)[6], double lo, double hi)
+{
+  const bool rising = acceleration(c, lo) < 0;
+  double x = 0.5 * (lo + hi);
+  for (int i = 0; i < PEAK_ITERATIONS && lo < x && x < hi; i++)
+  {
+    const double value = acceleration(c, x);
+    if (value == 0)
+    {
+      break;
+    }
+    if ((value < 0) == rising)
+    {
+      lo = x;
+    }
+    else
+    {
+      hi = x;
+    }
+    const double slope = jerk(c, x);
+    const double step = slope != 0 ? x - value / slope : lo;
+    const double next = step > lo && step < hi ? step : 0.5 * (lo + hi);
+    if (next == x)
+    {
+      break;
+    }
+    x = next;
+  }
+  return x;
+}
+
+// Stretch that brings the given peaks of a segment within the limits, at least 1
+static double stretchForPeaks(double peak_velocity, double peak_acceleration, double peak_jerk, double max_velocity,
+                              double max_acceleration, double max_jerk)
+{
+  return std::max(std::max(1.0, peak_velocity / max_velocity),
+                  std::max(std::sqrt(peak_acceleration / max_acceleration), std::cbrt(peak_jerk / max_jerk)));
+}
+
+// Peaks of a quintic segment. The velocity one is complete only once the acceleration roots
+// bracketed by lo and hi have been found and their velocities taken in.
+struct SegmentPeaks
+{
+  double velocity;
+  double acceleration;
+  double jerk;
+  size_t roots;
+  double lo[3];
+  double hi[3];
+};
+
+/*
+ * Peaks of a segment of duration t, see SegmentPeaks. Each peak is at an end of the segment or
+ * where the next derivative crosses zero: the jerk quadratic at its vertex, the acceleration
+ * cubic at the jerk's roots, and the velocity between those roots, where the acceleration is
+ * monotonic and its root is bracketed.
+ */
+static void findPeaks(const double (&c)[6], double t, SegmentPeaks& peaks)
+{
+  // Jerk peaks at the ends or at the vertex of the quadratic
+  peaks.jerk = std::max(std::fabs(jerk(c, 0)), std::fabs(jerk(c, t)));
+  if (c[5] != 0)
+  {
+    double vertex = -c[4] / (5 * c[5]);
+    if (vertex > 0 && vertex < t)
+    {
+      peaks.jerk = std::max(peaks.jerk, std::fabs(jerk(c, vertex)));
+    }
+  }
+
+  // Roots of the jerk inside the segment, in ascending order between the two ends
+  double bounds[4] = { 0, t, t, t };
+  size_t count = 1;
+  const double qa = 60 * c[5];
+  const double qb = 24 * c[4];
+  const double qc = 6 * c[3];
+  if (qa != 0)
+  {
+    double discriminant = qb * qb - 4 * qa * qc;
+    if (discriminant >= 0)
+    {
+      double root = std::sqrt(discriminant);
+      double roots[2] = { (-qb - root) / (2 * qa), (-qb + root) / (2 * qa) };
+      if (roots[0] > roots[1])
+      {
+        std::swap(roots[0], roots[1]);
+      }
+      for (double r : roots)
+      {
+        if (r > 0 && r < t)
+        {
+          bounds[count++] = r;
+        }
+      }
+    }
+  }
+  else if (qb != 0)
+  {
+    double r = -qc / qb;
+    if (r > 0 && r < t)
+    {
+      bounds[count++] = r;
+    }
+  }
+  bounds[count] = t;
+
+  // Acceleration peaks at the bounds, velocity at the ends or where the acceleration crosses zero
+  peaks.acceleration = 0;
+  peaks.velocity = std::max(std::fabs(velocity(c, 0)), std::fabs(velocity(c, t)));
+  peaks.roots = 0;
+  for (size_t i = 0; i <= count; i++)
+  {
+    peaks.acceleration = std::max(peaks.acceleration, std::fabs(acceleration(c, bounds[i])));
+    if (i < count && (acceleration(c, bounds[i]) < 0) != (acceleration(c, bounds[i + 1]) < 0))
+    {
+      peaks.lo[peaks.roots] = bounds[i];
+      peaks.hi[peaks.roots] = bounds[i + 1];
+      peaks.roots++;
+    }
+  }
+}
+
+#ifdef __SSE2__
+/*
+ * accelerationRoot() for two segments at once, one per lane, with the helpers it needs. Every
+ * step is the scalar one with the branches turned into masks, so the roots come out bit for bit
+ * the same. The iterations of both lanes run in step until neither continues.
+ */
+
+// a where \p mask is set, b elsewhere
+static __m128d select(__m128d mask, __m128d a, __m128d b)
+{
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+static __m128d inside(__m128d x, __m128d lo, __m128d hi)
+{
+  return _mm_and_pd(_mm_cmpgt_pd(x, lo), _mm_cmplt_pd(x, hi));
+}
+
+static __m128d velocity(const __m128d (&c)[6], __m128d t)
+{
+  __m128d value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(4), c[4]), _mm_mul_pd(_mm_mul_pd(t, _mm_set1_pd(5)), c[5]));
+  value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(3), c[3]), _mm_mul_pd(t, value));
+  value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(2), c[2]), _mm_mul_pd(t, value));
+  return _mm_add_pd(c[1], _mm_mul_pd(t, value));
+}
+
+static __m128d acceleration(const __m128d (&c)[6], __m128d t)
+{
+  __m128d value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(12), c[4]), _mm_mul_pd(_mm_mul_pd(t, _mm_set1_pd(20)), c[5]));
+  value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(6), c[3]), _mm_mul_pd(t, value));
+  return _mm_add_pd(_mm_mul_pd(_mm_set1_pd(2), c[2]), _mm_mul_pd(t, value));
+}
+
+static __m128d jerk(const __m128d (&c)[6], __m128d t)
+{
+  const __m128d value = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(24), c[4]), _mm_mul_pd(_mm_mul_pd(t, _mm_set1_pd(60)), c[5]));
+  return _mm_add_pd(_mm_mul_pd(_mm_set1_pd(6), c[3]), _mm_mul_pd(t, value));
+}
+
+static __m128d accelerationRoot(const __m128d (&c)[6], __m128d lo, __m128d hi)
+{
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d half = _mm_set1_pd(0.5);
+  const __m128d rising = _mm_cmplt_pd(acceleration(c, lo), zero);
+  __m128d x = _mm_mul_pd(half, _mm_add_pd(lo, hi));
+  __m128d active = inside(x, lo, hi);
+  for (int i = 0; i < PEAK_ITERATIONS && _mm_movemask_pd(active) != 0; i++)
+  {
+    const __m128d value = acceleration(c, x);
+    active = _mm_and_pd(active, _mm_cmpneq_pd(value, zero));
+    const __m128d root_below = _mm_xor_pd(_mm_cmplt_pd(value, zero), rising);
+    lo = select(_mm_andnot_pd(root_below, active), x, lo);
+    hi = select(_mm_and_pd(root_below, active), x, hi);
+
+    const __m128d slope = jerk(c, x);
+    const __m128d step = select(_mm_cmpneq_pd(slope, zero), _mm_sub_pd(x, _mm_div_pd(value, slope)), lo);
+    const __m128d next = select(inside(step, lo, hi), step, _mm_mul_pd(half, _mm_add_pd(lo, hi)));
+    active = _mm_and_pd(active, _mm_cmpneq_pd(next, x));
+    x = select(active, next, x);
+    active = _mm_and_pd(active, inside(x, lo, hi));
+  }
+  return x;
+}
+#endif
+
+// Share of each axis' acceleration and jerk limit given to changes of the path speed. The rest is
+// left to the curvature of the path, which accelerates the axes even at constant path speed.
+static const double SPEED_CHANGE_SHARE = 0.5;
+
+// Share of the path acceleration used to brake, leaving room for the jerk-limited ramp into it
+static const double BRAKING_SHARE = 0.5;
+
+// Slowest path speed of the simulation, so it reaches the last waypoint in finite time
+static const double MIN_PATH_SPEED = 1e-3;
+
+// Simulation steps per segment, and the longest step
+static const double STEPS_PER_SEGMENT = 8;
+static const double MAX_STEP = MIN_SEGMENT_TIME;
+
+/*
+ * The path is parameterized by s, the time it takes at full speed: every segment is as long as its
+ * slowest axis needs at its velocity limit. The path speed u = ds/dt is then at most 1, and with
+ * q', q'' and q''' the derivatives of an axis over s, the axis moves at q' u, accelerates at
+ * q' u' + q'' u^2 and jerks at q' u'' + 3 q'' u u' + q''' u^3. The first terms take the
+ * SPEED_CHANGE_SHARE of the limits, the curvature terms the rest.
+ */
+struct PathProfile
+{
+  std::vector<double> arc;                          // s at each waypoint
+  std::vector<double> first[TRAJECTORY_MAX_AXES];   // q' at each waypoint
+  std::vector<double> second[TRAJECTORY_MAX_AXES];  // q''
+  std::vector<double> max_speed;                    // Largest u
+  std::vector<double> max_acceleration;             // Largest |u'|
+  std::vector<double> max_jerk;                     // Largest |u''|
+  std::vector<double> speed;                        // u of the timing found
+  std::vector<double> acceleration;                 // u' of the timing found
+};
+
+// (limit / |derivative|)^(1/order), without dividing by zero
+static double speedBound(double limit, double derivative, int order)
+{
+  double magnitude = std::fabs(derivative);
+  if (magnitude == 0)
+  {
+    return HUGE_VAL;
+  }
+  double ratio = limit / magnitude;
+  return order == 1 ? ratio : order == 2 ? std::sqrt(ratio) : std::cbrt(ratio);
+}
+
+static void pathProfile(const TrajectoryBuffer& path, const JointLimits& limits, PathProfile& profile)
+{
+  const size_t points = path.size();
+  const size_t axes = path.axis_count;
+
+  std::vector<double> lengths(points - 1, MIN_SEGMENT_TIME);
+  for (size_t axis = 0; axis < axes; axis++)
+  {
+    const double* q = path.positions[axis].data();
+    const double inverse_velocity = 1.0 / limits.max_velocity[axis];
+    for (size_t k = 0; k + 1 < points; k++)
+    {
+      lengths[k] = std::max(lengths[k], std::fabs(q[k + 1] - q[k]) * inverse_velocity);
+    }
+  }
+
+  profile.arc.resize(points);
+  profile.arc[0] = 0;
+  for (size_t k = 1; k < points; k++)
+  {
+    profile.arc[k] = profile.arc[k - 1] + lengths[k - 1];
+  }
+
+  // No segment may take less than the minimum segment time
+  profile.max_speed.assign(points, HUGE_VAL);
+  for (size_t k = 0; k + 1 < points; k++)
+  {
+    profile.max_speed[k] = std::min(profile.max_speed[k], lengths[k] / MIN_SEGMENT_TIME);
+    profile.max_speed[k + 1] = std::min(profile.max_speed[k + 1], lengths[k] / MIN_SEGMENT_TIME);
+  }
+  profile.max_acceleration.assign(points, HUGE_VAL);
+  profile.max_jerk.assign(points, HUGE_VAL);
+
+  for (size_t axis = 0; axis < axes; axis++)
+  {
+    const double* q = path.positions[axis].data();
+    const double* s = profile.arc.data();
+    std::vector<double>& d1 = profile.first[axis];
+    std::vector<double>& d2 = profile.second[axis];
+    d1.resize(points);
+    d2.resize(points);
+
+    // Derivatives of the parabola through each waypoint and its neighbours, one-sided at the ends
+    d1[0] = (q[1] - q[0]) / lengths[0];
+    d1[points - 1] = (q[points - 1] - q[points - 2]) / lengths[points - 2];
+    d2[0] = 0;
+    d2[points - 1] = 0;
+    for (size_t k = 1; k + 1 < points; k++)
+    {
+      double before = (q[k] - q[k - 1]) / lengths[k - 1];
+      double after = (q[k + 1] - q[k]) / lengths[k];
+      double span = lengths[k - 1] + lengths[k];
+      d1[k] = (before * lengths[k] + after * lengths[k - 1]) / span;
+      d2[k] = 2 * (after - before) / span;
+    }
+
+    const double curvature_acceleration = (1 - SPEED_CHANGE_SHARE) * limits.max_acceleration[axis];
+    const double curvature_jerk = (1 - SPEED_CHANGE_SHARE) * limits.max_jerk[axis];
+    const double speed_acceleration = SPEED_CHANGE_SHARE * limits.max_acceleration[axis];
+    const double speed_jerk = SPEED_CHANGE_SHARE * limits.max_jerk[axis];
+    for (size_t k = 0; k < points; k++)
+    {
+      const size_t before = k > 0 ? k - 1 : 0;
+      const size_t after = k + 1 < points ? k + 1 : points - 1;
+      const double d3 = (d2[after] - d2[before]) / (s[after] - s[before]);
+
+      double speed = std::min(speedBound(limits.max_velocity[axis], d1[k], 1),
+                              speedBound(curvature_acceleration, d2[k], 2));
+      profile.max_speed[k] = std::min(profile.max_speed[k], std::min(speed, speedBound(curvature_jerk, d3, 3)));
+      profile.max_acceleration[k] = std::min(profile.max_acceleration[k], speedBound(speed_acceleration, d1[k], 1));
+      profile.max_jerk[k] = std::min(profile.max_jerk[k], speedBound(speed_jerk, d1[k], 1));
+    }
+  }
+
+  // Waypoints where nothing moves take the bounds of their neighbours
+  std::vector<double>* bounds[] = { &profile.max_acceleration, &profile.max_jerk };
+  for (std::vector<double>* bound : bounds)
+  {
+    std::vector<double>& b = *bound;
+    for (size_t k = 1; k < points; k++)
+    {
+      b[k] = std::isinf(b[k]) ? b[k - 1] : b[k];
+    }
+    for (size_t k = points - 1; k > 0; k--)
+    {
+      b[k - 1] = std::isinf(b[k - 1]) ? b[k] : b[k - 1];
+    }
+  }
+}
+
+/*
+ * Runs the path speed through the waypoints and stores the time between each pair in \p times,
+ * and the speed and acceleration at each waypoint in \p profile. The speed follows the lower of
+ * its bound and the braking curve to the end, looking ahead as far as it travels while its
+ * acceleration ramps over, and changes acceleration at the jerk bound, so the time law is smooth
+ * by construction.
+ */
+static void simulatePathSpeed(PathProfile& profile, std::vector<double>& braking, std::vector<double>& times)
+{
+  const std::vector<double>& arc = profile.arc;
+  const size_t points = arc.size();
+
+  // Squared speed from which the path can still slow down to every later bound, 0 at the end
+  braking[points - 1] = 0;
+  for (size_t k = points - 1; k > 0; k--)
+  {
+    double deceleration = BRAKING_SHARE * std::min(profile.max_acceleration[k - 1], profile.max_acceleration[k]);
+    braking[k - 1] = std::min(profile.max_speed[k - 1] * profile.max_speed[k - 1],
+                              braking[k] + 2 * deceleration * (arc[k] - arc[k - 1]));
+  }
+
+  double t = 0;
+  double passed = 0;
+  double s = 0;
+  double speed = 0;
+  double acceleration = 0;
+  size_t next = 1;  // Next waypoint to pass
+  profile.speed.assign(points, 0.0);
+  profile.acceleration.assign(points, 0.0);
+
+  while (next < points)
+  {
+    const size_t k = next - 1;
+    const double length = arc[next] - arc[k];
+
+    // Lowest bounds over the distance covered while the acceleration ramps from its current value
+    // to full braking
+    double max_acceleration = std::min(profile.max_acceleration[k], profile.max_acceleration[next]);
+    double max_jerk = std::min(profile.max_jerk[k], profile.max_jerk[next]);
+    const double dt = std::min(MAX_STEP, length / (STEPS_PER_SEGMENT * std::max(speed, MIN_PATH_SPEED)));
+    double target = braking[k] + (s - arc[k]) / length * (braking[next] - braking[k]);
+    const double horizon = s + speed * ((std::fabs(acceleration) + max_acceleration) / max_jerk + dt);
+    for (size_t i = next; i < points && arc[i - 1] <= horizon; i++)
+    {
+      max_acceleration = std::min(max_acceleration, profile.max_acceleration[i]);
+      max_jerk = std::min(max_jerk, profile.max_jerk[i]);
+      double distance = std::max(arc[i] - horizon, 0.0);
+      target = std::min(target, braking[i] + 2 * BRAKING_SHARE * max_acceleration * distance);
+    }
+    target = std::max(std::sqrt(target), MIN_PATH_SPEED);
+
+    // Acceleration from which the jerk bound just brings the speed onto the target
+    double error = target - speed;
+    double wanted = std::min(std::sqrt(2 * max_jerk * std::fabs(error)), max_acceleration);
+    wanted = error >= 0 ? wanted : -wanted;
+    acceleration += std::max(-max_jerk * dt, std::min(wanted - acceleration, max_jerk * dt));
+
+    double new_speed = std::max(speed + acceleration * dt, MIN_PATH_SPEED);
+    double new_s = s + 0.5 * (speed + new_speed) * dt;
+
+    // Times at which waypoints were passed, interpolated within the step
+    while (next < points && new_s >= arc[next])
+    {
+      double fraction = (arc[next] - s) / (new_s - s);
+      double crossing = t + dt * fraction;
+      times[next - 1] = std::max(crossing - passed, MIN_SEGMENT_TIME);
+      profile.speed[next] = speed + (new_speed - speed) * fraction;
+      profile.acceleration[next] = acceleration;
+      passed = crossing;
+      next++;
+    }
+
+    t += dt;
+    s = new_s;
+    speed = new_speed;
+  }
+}
+
+/*
+ * Factor by which segment k has to get longer to fit the limits of every axis, 1 if it already
+ * does. Scaling time by r scales velocity by 1/r, acceleration by 1/r^2 and jerk by 1/r^3.
+ */
+static double segmentStretch(const TrajectoryBuffer& path, const TrajectoryBuffer& states,
+                             const std::vector<double>& times, const JointLimits& limits, size_t k)
+{
+  double c[TRAJECTORY_MAX_AXES][6];
+  SegmentPeaks peaks[TRAJECTORY_MAX_AXES];
+
+  // The acceleration roots of all axes, polished together below as they take most of the time
+  size_t root_axis[3 * TRAJECTORY_MAX_AXES];
+  double root_lo[3 * TRAJECTORY_MAX_AXES];
+  double root_hi[3 * TRAJECTORY_MAX_AXES];
+  size_t roots = 0;
+  for (size_t axis = 0; axis < path.axis_count; axis++)
+  {
+    quinticCoefficients(path.positions[axis][k], states.velocities[axis][k], states.accelerations[axis][k],
+                        path.positions[axis][k + 1], states.velocities[axis][k + 1],
+                        states.accelerations[axis][k + 1], times[k], c[axis]);
+    findPeaks(c[axis], times[k], peaks[axis]);
+    for (size_t i = 0; i < peaks[axis].roots; i++)
+    {
+      root_axis[roots] = axis;
+      root_lo[roots] = peaks[axis].lo[i];
+      root_hi[roots] = peaks[axis].hi[i];
+      roots++;
+    }
+  }
+
+  size_t i = 0;
+#ifdef __SSE2__
+  // Two roots per iteration, of the same axis or not; an odd one out is left to the scalar loop
+  for (; i + 2 <= roots; i += 2)
+  {
+    const double* first = c[root_axis[i]];
+    const double* second = c[root_axis[i + 1]];
+    __m128d pair[6];
+    for (size_t j = 0; j < 6; j++)
+    {
+      pair[j] = _mm_set_pd(second[j], first[j]);
+    }
+
+    const __m128d x = accelerationRoot(pair, _mm_loadu_pd(root_lo + i), _mm_loadu_pd(root_hi + i));
+    double peak[2];
+    _mm_storeu_pd(peak, _mm_andnot_pd(_mm_set1_pd(-0.0), velocity(pair, x)));
+    peaks[root_axis[i]].velocity = std::max(peaks[root_axis[i]].velocity, peak[0]);
+    peaks[root_axis[i + 1]].velocity = std::max(peaks[root_axis[i + 1]].velocity, peak[1]);
+  }
+#endif
+  for (; i < roots; i++)
+  {
+    const double x = accelerationRoot(c[root_axis[i]], root_lo[i], root_hi[i]);
+    peaks[root_axis[i]].velocity = std::max(peaks[root_axis[i]].velocity, std::fabs(velocity(c[root_axis[i]], x)));
+  }
+
+  double stretch = 1.0;
+  for (size_t axis = 0; axis < path.axis_count; axis++)
+  {
+    stretch = std::max(stretch, stretchForPeaks(peaks[axis].velocity, peaks[axis].acceleration, peaks[axis].jerk,
+                                                limits.max_velocity[axis], limits.max_acceleration[axis],
+                                                limits.max_jerk[axis]));
+  }
+  return stretch;
+}
+
+// Whole milliseconds not shorter than t, ignoring what is left of floating point error
+static double quantizeTime(double t)
+{
+  return std::max(1.0, std::ceil(t / TIME_RESOLUTION - QUANTIZE_TOLERANCE)) * TIME_RESOLUTION;
+}
+
+// Time the quintic needs to go from rest to rest over segment k
+static double restTime(const TrajectoryBuffer& path, const JointLimits& limits, size_t k)
+{
+  double time = MIN_SEGMENT_TIME;
+  for (size_t axis = 0; axis < path.axis_count; axis++)
+  {
+    double distance = std::fabs(path.positions[axis][k + 1] - path.positions[axis][k]);
+    time = std::max(time, REST_PEAK_VELOCITY * distance / limits.max_velocity[axis]);
+    time = std::max(time, std::sqrt(REST_PEAK_ACCELERATION * distance / limits.max_acceleration[axis]));
+    time = std::max(time, std::cbrt(REST_PEAK_JERK * distance / limits.max_jerk[axis]));
+  }
+  return time;
+}
+
+/*
+ * Rounds the timing stretched by \p scale up to whole milliseconds into \p times, slows the states
+ * at each waypoint by as much as the two segments around it grew, and returns the worst stretch
+ * factor of the rounded segments.
+ */
+static double quantizedStretch(const TrajectoryBuffer& path, const JointLimits& limits,
+                               const std::vector<double>& planned_times, const TrajectoryBuffer& planned_states,
+                               const std::vector<bool>& at_rest, double scale, std::vector<double>& times,
+                               TrajectoryBuffer& states)
+{
+  const size_t segments = times.size();
+  for (size_t k = 0; k < segments; k++)
+  {
+    double time = planned_times[k] * scale;
+    times[k] = quantizeTime(at_rest[k] ? std::min(time, restTime(path, limits, k)) : time);
+  }
+  for (size_t k = 0; k <= segments; k++)
+  {
+    double planned = (k > 0 ? planned_times[k - 1] : 0) + (k < segments ? planned_times[k] : 0);
+    double rounded = (k > 0 ? times[k - 1] : 0) + (k < segments ? times[k] : 0);
+    double inverse = planned / rounded;
+    for (size_t axis = 0; axis < path.axis_count; axis++)
+    {
+      states.velocities[axis][k] = planned_states.velocities[axis][k] * inverse;
+      states.accelerations[axis][k] = planned_states.accelerations[axis][k] * inverse * inverse;
+    }
+  }
+
+  double worst = 1.0;
+  for (size_t k = 0; k < segments; k++)
+  {
+    worst = std::max(worst, segmentStretch(path, states, times, limits, k));
+  }
+  return worst;
+}
+
+bool parameterizeTrajectory(const TrajectoryBuffer& path, const JointLimits& limits, TrajectoryBuffer& trajectory)
+{
+  const size_t points = path.size();
+  const size_t axes = path.axis_count;
+  if (points < 2 || axes == 0 || axes > TRAJECTORY_MAX_AXES || axes != limits.axis_count)
+  {
+    return false;
+  }
+  const size_t segments = points - 1;
+
+  PathProfile profile;
+  pathProfile(path, limits, profile);
+
+  std::vector<double> times(segments);
+  std::vector<double> braking(points);
+  std::vector<double> stretch(segments);
+  TrajectoryBuffer states;
+  states.resize(axes, points);
+
+  // Check the quintic segments of each timing and slow the path down wherever one of them still
+  // breaks a limit. The round that is shortest once stretched as a whole is kept.
+  std::vector<double> best_times;
+  TrajectoryBuffer best_states;
+  double best_total = HUGE_VAL;
+  double best_stretch = HUGE_VAL;
+  for (int round = 0; round < MAX_STRETCH_ROUNDS && best_stretch > 1 + STRETCH_TOLERANCE; round++)
+  {
+    simulatePathSpeed(profile, braking, times);
+
+    // The axes follow the path: q' u and q' u' + q'' u^2, coming to rest at the end
+    profile.speed[segments] = 0;
+    profile.acceleration[segments] = 0;
+    for (size_t axis = 0; axis < axes; axis++)
+    {
+      const double* d1 = profile.first[axis].data();
+      const double* d2 = profile.second[axis].data();
+      const double* u = profile.speed.data();
+      const double* du = profile.acceleration.data();
+      double* v = states.velocities[axis].data();
+      double* a = states.accelerations[axis].data();
+      for (size_t k = 0; k < points; k++)
+      {
+        v[k] = d1[k] * u[k];
+        a[k] = d1[k] * du[k] + d2[k] * u[k] * u[k];
+      }
+    }
+
+    double worst = 1.0;
+    double total = 0;
+    for (size_t k = 0; k < segments; k++)
+    {
+      stretch[k] = segmentStretch(path, states, times, limits, k);
+      worst = std::max(worst, stretch[k]);
+      total += times[k];
+    }
+    if (round == 0 || total * worst < best_total)
+    {
+      best_total = total * worst;
+      best_stretch = worst;
+      best_times = times;
+      best_states = states;
+    }
+
+    for (size_t k = 0; k < segments; k++)
+    {
+      if (stretch[k] > 1 + STRETCH_TOLERANCE)
+      {
+        double speed = (profile.arc[k + 1] - profile.arc[k]) / (times[k] * stretch[k]);
+        profile.max_speed[k] = std::min(profile.max_speed[k], speed);
+        profile.max_speed[k + 1] = std::min(profile.max_speed[k + 1], speed);
+      }
+    }
+  }
+
+  // Segments that start and end at rest need no longer than the closed form allows
+  std::vector<bool> at_rest(segments, true);
+  for (size_t k = 0; k < segments; k++)
+  {
+    for (size_t axis = 0; axis < axes && at_rest[k]; axis++)
+    {
+      at_rest[k] = best_states.velocities[axis][k] == 0 && best_states.accelerations[axis][k] == 0 &&
+                   best_states.velocities[axis][k + 1] == 0 && best_states.accelerations[axis][k + 1] == 0;
+    }
+  }
+
+  // Stretching the whole timing by r scales every velocity by 1/r, acceleration by 1/r^2 and jerk
+  // by 1/r^3, so the worst segment's factor would bring all of them within the limits. Rounding to
+  // milliseconds moves the segments apart again, so the stretch is searched on the rounded timing:
+  // grown by the worst factor until it fits, then narrowed down between the two last tries.
+  double scale = std::max(best_stretch, 1.0);
+  double failed = 0;
+  double fitting = HUGE_VAL;
+  for (int round = 0; round < MAX_QUANTIZE_ROUNDS; round++)
+  {
+    double worst = quantizedStretch(path, limits, best_times, best_states, at_rest, scale, times, states);
+    if (worst <= 1 + STRETCH_TOLERANCE)
+    {
+      fitting = scale;
+    }
+    else
+    {
+      failed = scale;
+    }
+    if (failed == 0 || fitting <= failed * (1 + QUANTIZE_SEARCH_TOLERANCE))
+    {
+      break;
+    }
+    scale = std::isinf(fitting) ? scale * worst : std::sqrt(failed * fitting);
+  }
+  const bool fits = !std::isinf(fitting);
+  if (fits && scale != fitting)
+  {
+    quantizedStretch(path, limits, best_times, best_states, at_rest, fitting, times, states);
+  }
+
+  // Stopping at every waypoint always fits
+  if (!fits)
+  {
+    for (size_t k = 0; k < segments; k++)
+    {
+      times[k] = quantizeTime(restTime(path, limits, k));
+    }
+    for (size_t axis = 0; axis < axes; axis++)
+    {
+      std::fill(states.velocities[axis].begin(), states.velocities[axis].end(), 0.0);
+      std::fill(states.accelerations[axis].begin(), states.accelerations[axis].end(), 0.0);
+    }
+  }
+
+  trajectory.resize(axes, segments);
+  for (size_t axis = 0; axis < axes; axis++)
+  {
+    std::copy(path.positions[axis].begin() + 1, path.positions[axis].end(), trajectory.positions[axis].begin());
+    std::copy(states.velocities[axis].begin() + 1, states.velocities[axis].end(),
+              trajectory.velocities[axis].begin());
+    std::copy(states.accelerations[axis].begin() + 1, states.accelerations[axis].end(),
+              trajectory.accelerations[axis].begin());
+  }
+  trajectory.goal_times = times;
+  return true;
+}
+
+}  // namespace hrsdk
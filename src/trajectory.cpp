@@ -0,0 +1,247 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+#include <iterator>
+
+#include <hiwin_robot_client_library/trajectory.hpp>
+
+namespace hrsdk
+{
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++)
+  {
+    hash = (hash ^ bytes[i]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+static bool samePoints(const std::vector<TrajectoryPoint>& a, const std::vector<TrajectoryPoint>& b)
+{
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(TrajectoryPoint)) == 0;
+}
+
+void encodeTrajectoryPoint(Commandformat& w, const TrajectoryPoint& point, TrajectoryType type, double goal_time)
+{
+  switch (type)
+  {
+    case TrajectoryType::Linear:
+      protocol::LinearSplinePoint::encode(w, point.positions, goal_time);
+      break;
+    case TrajectoryType::Cubic:
+      protocol::CubicSplinePoint::encode(w, point.positions, point.velocities, goal_time);
+      break;
+    case TrajectoryType::Quintic:
+      protocol::QuinticSplinePoint::encode(w, point.positions, point.velocities, point.accelerations, goal_time);
+      break;
+  }
+}
+
+TrajectoryBuffer::TrajectoryBuffer() : axis_count(0)
+{
+}
+
+void TrajectoryBuffer::resize(size_t axes, size_t points)
+{
+  axis_count = axes;
+  for (size_t axis = 0; axis < TRAJECTORY_MAX_AXES; axis++)
+  {
+    size_t size = axis < axes ? points : 0;
+    positions[axis].resize(size, 0.0);
+    velocities[axis].resize(size, 0.0);
+    accelerations[axis].resize(size, 0.0);
+  }
+  goal_times.resize(points, 0.0);
+}
+
+void TrajectoryBuffer::fromPoints(const std::vector<TrajectoryPoint>& points, size_t axes)
+{
+  resize(axes, points.size());
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    for (size_t axis = 0; axis < axes; axis++)
+    {
+      positions[axis][i] = points[i].positions[axis];
+      velocities[axis][i] = points[i].velocities[axis];
+      accelerations[axis][i] = points[i].accelerations[axis];
+    }
+    goal_times[i] = points[i].goal_time;
+  }
+}
+
+void TrajectoryBuffer::toPoints(std::vector<TrajectoryPoint>& points) const
+{
+  points.assign(size(), TrajectoryPoint());
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    for (size_t axis = 0; axis < axis_count; axis++)
+    {
+      points[i].positions[axis] = positions[axis][i];
+      points[i].velocities[axis] = velocities[axis][i];
+      points[i].accelerations[axis] = accelerations[axis][i];
+    }
+    points[i].goal_time = goal_times[i];
+  }
+}
+
+std::shared_ptr<const CompiledTrajectory> CompiledTrajectory::compile(const std::vector<TrajectoryPoint>& points,
+                                                                      TrajectoryType type)
+{
+  std::shared_ptr<CompiledTrajectory> trajectory = std::make_shared<CompiledTrajectory>();
+  trajectory->type = type;
+  trajectory->hash = hashOf(points, type);
+  trajectory->points = points;
+  trajectory->frames.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    encodeTrajectoryPoint(trajectory->frames[i], points[i], type, points[i].goal_time);
+  }
+  return trajectory;
+}
+
+uint64_t CompiledTrajectory::hashOf(const std::vector<TrajectoryPoint>& points, TrajectoryType type)
+{
+  uint64_t hash = fnv1a(FNV_OFFSET_BASIS, &type, sizeof(type));
+  return fnv1a(hash, points.data(), points.size() * sizeof(TrajectoryPoint));
+}
+
+size_t CompiledTrajectory::bytes() const
+{
+  return sizeof(CompiledTrajectory) + points.capacity() * sizeof(TrajectoryPoint) +
+         frames.capacity() * sizeof(Commandformat);
+}
+
+TrajectoryCache::TrajectoryCache(size_t max_bytes) : max_bytes_(max_bytes), stats_()
+{
+}
+
+std::shared_ptr<const CompiledTrajectory> TrajectoryCache::find(uint64_t hash,
+                                                                const std::vector<TrajectoryPoint>& points,
+                                                                TrajectoryType type)
+{
+  auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    const CompiledTrajectory& cached = **it->second;
+    if (cached.type == type && samePoints(cached.points, points))
+    {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return lru_.front();
+    }
+  }
+  return std::shared_ptr<const CompiledTrajectory>();
+}
+
+std::shared_ptr<const CompiledTrajectory> TrajectoryCache::get(const std::vector<TrajectoryPoint>& points,
+                                                               TrajectoryType type)
+{
+  const uint64_t hash = CompiledTrajectory::hashOf(points, type);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<const CompiledTrajectory> cached = find(hash, points, type);
+    if (cached)
+    {
+      stats_.hits++;
+      return cached;
+    }
+    stats_.misses++;
+  }
+
+  // Compile outside the lock so other lookups are not held up
+  std::shared_ptr<const CompiledTrajectory> trajectory = CompiledTrajectory::compile(points, type);
+  const size_t bytes = trajectory->bytes();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Another thread missing on the same trajectory may have inserted it meanwhile; keep one entry
+  std::shared_ptr<const CompiledTrajectory> cached = find(hash, points, type);
+  if (cached)
+  {
+    return cached;
+  }
+
+  if (bytes <= max_bytes_)
+  {
+    lru_.push_front(trajectory);
+    index_.emplace(hash, lru_.begin());
+    stats_.entries++;
+    stats_.bytes += bytes;
+    evict();
+  }
+  return trajectory;
+}
+
+void TrajectoryCache::evict()
+{
+  while (stats_.bytes > max_bytes_ && !lru_.empty())
+  {
+    const std::shared_ptr<const CompiledTrajectory>& oldest = lru_.back();
+    auto range = index_.equal_range(oldest->hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second == std::prev(lru_.end()))
+      {
+        index_.erase(it);
+        break;
+      }
+    }
+    stats_.bytes -= oldest->bytes();
+    stats_.entries--;
+    stats_.evictions++;
+    lru_.pop_back();
+  }
+}
+
+void TrajectoryCache::setMaxBytes(size_t max_bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_bytes_ = max_bytes;
+  evict();
+}
+
+void TrajectoryCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  index_.clear();
+  stats_.entries = 0;
+  stats_.bytes = 0;
+}
+
+TrajectoryCacheStats TrajectoryCache::getStats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace hrsdk
@@ -0,0 +1,187 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <hiwin_robot_client_library/trajectory_validation.hpp>
+
+namespace hrsdk
+{
+// Limits of one axis, with the checks that do not apply to the trajectory type switched off
+struct AxisBounds
+{
+  double min_position;
+  double max_position;
+  double max_velocity;
+  double max_acceleration;
+  double max_jerk;
+  bool velocity;
+  bool acceleration;
+};
+
+/*
+ * Checks point k of one axis and, past the first point, the step to it from the one before.
+ * Every comparison is written so that NaN fails it.
+ */
+static LimitViolation checkPoint(const double* q, const double* v, const double* a, const double* t, size_t k,
+                                 const AxisBounds& b)
+{
+  if (!(q[k] >= b.min_position && q[k] <= b.max_position))
+  {
+    return LimitViolation::Position;
+  }
+  if (b.velocity && !(std::fabs(v[k]) <= b.max_velocity))
+  {
+    return LimitViolation::Velocity;
+  }
+  if (b.acceleration && !(std::fabs(a[k]) <= b.max_acceleration))
+  {
+    return LimitViolation::Acceleration;
+  }
+  if (k > 0)
+  {
+    if (!(std::fabs(q[k] - q[k - 1]) <= b.max_velocity * t[k]))
+    {
+      return LimitViolation::PositionStep;
+    }
+    if (b.velocity && !(std::fabs(v[k] - v[k - 1]) <= b.max_acceleration * t[k]))
+    {
+      return LimitViolation::VelocityStep;
+    }
+    if (b.acceleration && !(std::fabs(a[k] - a[k - 1]) <= b.max_jerk * t[k]))
+    {
+      return LimitViolation::AccelerationStep;
+    }
+  }
+  return LimitViolation::None;
+}
+
+// Index of the first point of one axis before \p end that breaks a limit, \p end if none does
+static size_t firstViolation(const double* q, const double* v, const double* a, const double* t, size_t end,
+                             const AxisBounds& b)
+{
+  if (end == 0 || checkPoint(q, v, a, t, 0, b) != LimitViolation::None)
+  {
+    return 0;
+  }
+
+  size_t k = 1;
+#ifdef __SSE2__
+  const __m128d sign_bit = _mm_set1_pd(-0.0);
+  const __m128d min_position = _mm_set1_pd(b.min_position);
+  const __m128d max_position = _mm_set1_pd(b.max_position);
+  const __m128d max_velocity = _mm_set1_pd(b.max_velocity);
+  const __m128d max_acceleration = _mm_set1_pd(b.max_acceleration);
+  const __m128d max_jerk = _mm_set1_pd(b.max_jerk);
+
+  // Two points per iteration; a pair with a failed comparison is left to the scalar loop, which
+  // tells which point and which limit it is
+  for (; k + 2 <= end; k += 2)
+  {
+    const __m128d time = _mm_loadu_pd(t + k);
+    const __m128d position = _mm_loadu_pd(q + k);
+    const __m128d position_step = _mm_andnot_pd(sign_bit, _mm_sub_pd(position, _mm_loadu_pd(q + k - 1)));
+    __m128d ok = _mm_and_pd(_mm_cmpge_pd(position, min_position), _mm_cmple_pd(position, max_position));
+    ok = _mm_and_pd(ok, _mm_cmple_pd(position_step, _mm_mul_pd(max_velocity, time)));
+
+    if (b.velocity)
+    {
+      const __m128d velocity = _mm_loadu_pd(v + k);
+      const __m128d velocity_step = _mm_andnot_pd(sign_bit, _mm_sub_pd(velocity, _mm_loadu_pd(v + k - 1)));
+      ok = _mm_and_pd(ok, _mm_cmple_pd(_mm_andnot_pd(sign_bit, velocity), max_velocity));
+      ok = _mm_and_pd(ok, _mm_cmple_pd(velocity_step, _mm_mul_pd(max_acceleration, time)));
+    }
+    if (b.acceleration)
+    {
+      const __m128d acceleration = _mm_loadu_pd(a + k);
+      const __m128d acceleration_step = _mm_andnot_pd(sign_bit, _mm_sub_pd(acceleration, _mm_loadu_pd(a + k - 1)));
+      ok = _mm_and_pd(ok, _mm_cmple_pd(_mm_andnot_pd(sign_bit, acceleration), max_acceleration));
+      ok = _mm_and_pd(ok, _mm_cmple_pd(acceleration_step, _mm_mul_pd(max_jerk, time)));
+    }
+
+    if (_mm_movemask_pd(ok) != 3)
+    {
+      break;
+    }
+  }
+#endif
+
+  for (; k < end; k++)
+  {
+    if (checkPoint(q, v, a, t, k, b) != LimitViolation::None)
+    {
+      return k;
+    }
+  }
+  return end;
+}
+
+bool validateTrajectory(const TrajectoryBuffer& trajectory, TrajectoryType type, const JointLimits& limits,
+                        TrajectoryViolation& violation)
+{
+  const size_t points = trajectory.size();
+  const size_t axes = std::min(trajectory.axis_count, limits.axis_count);
+  violation.violation = LimitViolation::None;
+  violation.index = points;
+  violation.axis = 0;
+
+  for (size_t axis = 0; axis < axes; axis++)
+  {
+    AxisBounds b;
+    const bool position_limited = limits.min_position[axis] != limits.max_position[axis];
+    b.min_position = position_limited ? limits.min_position[axis] : -HUGE_VAL;
+    b.max_position = position_limited ? limits.max_position[axis] : HUGE_VAL;
+    b.max_velocity = limits.max_velocity[axis];
+    b.max_acceleration = limits.max_acceleration[axis];
+    b.max_jerk = limits.max_jerk[axis];
+    b.velocity = type != TrajectoryType::Linear;
+    b.acceleration = type == TrajectoryType::Quintic;
+
+    // Only points before the earliest violation found so far are of interest
+    const double* q = trajectory.positions[axis].data();
+    const double* v = trajectory.velocities[axis].data();
+    const double* a = trajectory.accelerations[axis].data();
+    const double* t = trajectory.goal_times.data();
+    const size_t k = firstViolation(q, v, a, t, violation.index, b);
+    if (k < violation.index)
+    {
+      violation.violation = checkPoint(q, v, a, t, k, b);
+      violation.index = k;
+      violation.axis = axis;
+    }
+  }
+
+  return violation.violation == LimitViolation::None;
+}
+
+}  // namespace hrsdk
@@ -0,0 +1,210 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_BASELINE_ENCODERS_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_BASELINE_ENCODERS_HPP_
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <hiwin_robot_client_library/commander.hpp>
+
+/*!
+ * \brief The hand-written frame encoders the descriptor table replaced, kept as the reference.
+ *
+ * Each function does what the encoding half of the former Commander method of the same name did,
+ * with the same arithmetic, but writes into \p w instead of the socket.
+ */
+namespace baseline
+{
+using hrsdk::Commandformat;
+using hrsdk::CommandId;
+
+inline void cmdOnly(Commandformat& w, CommandId id)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(id);
+}
+
+inline void wordCommand(Commandformat& w, CommandId id, uint16_t value)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(id);
+  w.param[0] = value;
+}
+
+inline void getPermissions(Commandformat& w)
+{
+  wordCommand(w, CommandId::GetPermissions, 0);
+}
+
+inline void setLogLevel(Commandformat& w, hrsdk::LogLevels level)
+{
+  wordCommand(w, CommandId::SetLogLevel, static_cast<uint16_t>(level));
+}
+
+inline void setServoAmpState(Commandformat& w, bool enable)
+{
+  wordCommand(w, CommandId::SetServoAmp, static_cast<uint16_t>(enable));
+}
+
+inline void setPtpSpeed(Commandformat& w, int ratio)
+{
+  wordCommand(w, CommandId::SetPtpSpeed, static_cast<uint16_t>(ratio));
+}
+
+inline void setOverrideRatio(Commandformat& w, int ratio)
+{
+  wordCommand(w, CommandId::SetOverRideRatio, static_cast<uint16_t>(ratio));
+}
+
+inline void setRobotMode(Commandformat& w, hrsdk::ControlMode mode)
+{
+  wordCommand(w, CommandId::SetRobotMode, static_cast<uint16_t>(mode));
+}
+
+inline void getActualPosition(Commandformat& w)
+{
+  wordCommand(w, CommandId::GetActualPosition, static_cast<uint16_t>(hrsdk::SpaceOperationTypes::Joint));
+}
+
+inline void asciiPtp(Commandformat& w, CommandId id, const double* positions, size_t count)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(id);
+
+  // Smooth on between the points
+  w.param[0] = 1;
+
+  std::string pos_str = "";
+  for (size_t i = 0; i < count; i++)
+  {
+    if (i != 0)
+    {
+      pos_str += ",";
+    }
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(7) << (positions[i] * (180 / M_PI));
+    pos_str += stream.str();
+  }
+  w.param[1] = pos_str.length();
+  for (size_t i = 0; i < pos_str.length(); i++)
+  {
+    w.param[2 + i] = pos_str[i];
+  }
+}
+
+inline void ptpJoint(Commandformat& w, const double* positions)
+{
+  asciiPtp(w, CommandId::PtpJoint, positions, 6);
+}
+
+inline void extPtpJoint(Commandformat& w, const double* positions)
+{
+  asciiPtp(w, CommandId::ExtPtpJoint, positions, 9);
+}
+
+inline void ptpJoint(Commandformat& w, const double* positions, double acc_time, double ratio)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(CommandId::PtpJointWithVelocity);
+
+  // Acceleration time
+  int32_t acceleration_time = static_cast<int>(std::round(acc_time * 1000));
+  memcpy(&w.param[0], &acceleration_time, sizeof(int32_t));
+
+  // PTP motion ratio
+  int32_t ratio_integer = static_cast<int>(std::round(ratio * 1000));
+  memcpy(&w.param[2], &ratio_integer, sizeof(int32_t));
+
+  // Smooth on between the points
+  w.param[4] = 1;
+
+  double pos_deg;
+  int32_t deg_integer;
+  for (size_t i = 0; i < 6; i++)
+  {
+    pos_deg = positions[i] * (180 / M_PI) * 1000.0;
+    deg_integer = static_cast<int>(std::round(pos_deg));
+    memcpy(&w.param[(i * 2) + 5], &deg_integer, sizeof(int32_t));
+  }
+}
+
+inline void milliDegrees(Commandformat& w, size_t index, const double* values)
+{
+  double deg_float;
+  int32_t deg_integer;
+  for (size_t i = 0; i < 9; i++)
+  {
+    deg_float = values[i] * (180 / M_PI) * 1000.0;
+    deg_integer = static_cast<int>(std::round(deg_float));
+    memcpy(&w.param[(i * 2) + index], &deg_integer, sizeof(int32_t));
+  }
+}
+
+inline void goalTime(Commandformat& w, size_t index, double goal_time_sec)
+{
+  int32_t t_integer = static_cast<int>(std::round(goal_time_sec * 1000.0));
+  memcpy(&w.param[index], &t_integer, sizeof(int32_t));
+}
+
+inline void linearSplinePoint(Commandformat& w, const double* positions, double goal_time_sec)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(CommandId::LinearSplinePoint);
+  milliDegrees(w, 0, positions);
+  goalTime(w, 18, goal_time_sec);
+}
+
+inline void cubicSplinePoint(Commandformat& w, const double* positions, const double* velocities,
+                             double goal_time_sec)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(CommandId::CubicSplinePoint);
+  milliDegrees(w, 0, positions);
+  milliDegrees(w, 18, velocities);
+  goalTime(w, 36, goal_time_sec);
+}
+
+inline void quintSplinePoint(Commandformat& w, const double* positions, const double* velocities,
+                             const double* acceleration, double goal_time_sec)
+{
+  w = Commandformat();
+  w.cmd_id = static_cast<uint16_t>(CommandId::QuinticSplinePoint);
+  milliDegrees(w, 0, positions);
+  milliDegrees(w, 18, velocities);
+  milliDegrees(w, 36, acceleration);
+  goalTime(w, 54, goal_time_sec);
+}
+
+}  // namespace baseline
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_BASELINE_ENCODERS_HPP_
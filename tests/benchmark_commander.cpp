@@ -0,0 +1,250 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <hiwin_robot_client_library/commander.hpp>
+
+using namespace hrsdk;
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+// Time the controller spends on each frame, one after the other
+const std::chrono::microseconds SERVICE_TIME(100);
+
+// Frames in flight, and threads queueing requests behind them
+const size_t PIPELINE_DEPTH = 8;
+const size_t LOAD_THREADS = 16;
+
+/*
+ * Controller on localhost that answers every frame in order, one SERVICE_TIME after the previous
+ * one, and notes when a motion abort comes in.
+ */
+class SlowController
+{
+private:
+  int listen_fd_;
+  int fd_;
+  std::thread reader_;
+  std::thread writer_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::pair<Clock::time_point, Responseformat>> queue_;
+  bool running_;
+  std::atomic<int64_t> abort_arrival_;
+
+  void read()
+  {
+    Commandformat frame;
+    size_t filled = 0;
+    Clock::time_point busy_until = Clock::now();
+    while (true)
+    {
+      ssize_t n = ::recv(fd_, reinterpret_cast<uint8_t*>(&frame) + filled, sizeof(frame) - filled, 0);
+      if (n <= 0)
+      {
+        break;
+      }
+      filled += n;
+      if (filled < sizeof(frame))
+      {
+        continue;
+      }
+      filled = 0;
+
+      Clock::time_point now = Clock::now();
+      if (frame.cmd_id == static_cast<uint16_t>(CommandId::MotionAbort))
+      {
+        abort_arrival_ = now.time_since_epoch().count();
+      }
+      Responseformat response = {};
+      response.cmd_id = frame.cmd_id;
+      busy_until = std::max(busy_until, now) + SERVICE_TIME;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.emplace_back(busy_until, response);
+      cv_.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+    cv_.notify_one();
+  }
+
+  void write()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      cv_.wait(lock, [this] { return !queue_.empty() || !running_; });
+      if (queue_.empty())
+      {
+        break;
+      }
+      std::pair<Clock::time_point, Responseformat> next = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+      std::this_thread::sleep_until(next.first);
+      ::send(fd_, &next.second, sizeof(next.second), MSG_NOSIGNAL);
+      lock.lock();
+    }
+  }
+
+public:
+  SlowController() : listen_fd_(::socket(AF_INET, SOCK_STREAM, 0)), fd_(-1), running_(true), abort_arrival_(0)
+  {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::listen(listen_fd_, 1);
+  }
+
+  ~SlowController()
+  {
+    ::shutdown(fd_, SHUT_RDWR);
+    if (reader_.joinable())
+    {
+      reader_.join();
+    }
+    if (writer_.joinable())
+    {
+      writer_.join();
+    }
+    ::close(fd_);
+    ::close(listen_fd_);
+  }
+
+  int port() const
+  {
+    sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+    return ntohs(address.sin_port);
+  }
+
+  // Takes the connection the Commander made and starts answering it
+  void accept()
+  {
+    fd_ = ::accept(listen_fd_, nullptr, nullptr);
+    int flag = 1;
+    ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    reader_ = std::thread(&SlowController::read, this);
+    writer_ = std::thread(&SlowController::write, this);
+  }
+
+  Clock::time_point abortArrival() const
+  {
+    return Clock::time_point(Clock::duration(abort_arrival_.load()));
+  }
+};
+
+double processCpuSeconds()
+{
+  rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+}  // namespace
+
+/*
+ * Time motionAbort() takes with the pipeline full and LOAD_THREADS more requests waiting for room.
+ * to_controller_us is how long the abort frame took to reach the controller, which the priority
+ * lane decides; the rest of the round trip is the pipeline draining in front of its response.
+ * cpu_ms is the CPU time the whole process spent per abort, waiting writers included.
+ */
+static void BM_MotionAbortUnderLoad(benchmark::State& state)
+{
+  SlowController controller;
+  Commander commander("127.0.0.1", controller.port());
+  commander.setPipelineDepth(PIPELINE_DEPTH);
+  std::thread acceptor(&SlowController::accept, &controller);
+  if (!commander.connect())
+  {
+    acceptor.join();
+    state.SkipWithError("Could not connect to the mock controller");
+    return;
+  }
+  acceptor.join();
+
+  std::atomic<bool> loading(true);
+  std::vector<std::thread> load;
+  for (size_t i = 0; i < LOAD_THREADS; i++)
+  {
+    load.emplace_back([&commander, &loading] {
+      double positions[6];
+      while (loading)
+      {
+        commander.getActualPosition(positions);
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  double to_controller = 0;
+  const double cpu_start = processCpuSeconds();
+  for (auto _ : state)
+  {
+    const Clock::time_point start = Clock::now();
+    benchmark::DoNotOptimize(commander.motionAbort());
+    to_controller += std::chrono::duration<double, std::micro>(controller.abortArrival() - start).count();
+  }
+  const double cpu = processCpuSeconds() - cpu_start;
+
+  loading = false;
+  commander.disconnect();
+  for (std::thread& thread : load)
+  {
+    thread.join();
+  }
+
+  state.counters["to_controller_us"] = benchmark::Counter(to_controller, benchmark::Counter::kAvgIterations);
+  state.counters["cpu_ms"] = benchmark::Counter(1e3 * cpu, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MotionAbortUnderLoad)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
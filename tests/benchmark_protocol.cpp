@@ -0,0 +1,114 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+
+#include <hiwin_robot_client_library/commander.hpp>
+
+#include "baseline_encoders.hpp"
+
+using namespace hrsdk;
+
+// Not const, and clobbered every iteration, so the compiler cannot fold the encoding at build time
+double POSITIONS[9] = { 0.1, -1.2, 0.75, 2.9, -0.33, 1.5, 0.02, -3.1, 0.6 };
+double VELOCITIES[9] = { 0.5, -0.4, 0.3, -0.2, 0.1, 0.0, -0.1, 0.2, -0.3 };
+double ACCELERATIONS[9] = { 1.0, -2.0, 3.0, -1.5, 0.5, -0.25, 0.0, 0.75, -1.0 };
+
+static void BM_PtpJointBaseline(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    baseline::ptpJoint(w, POSITIONS);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_PtpJointBaseline);
+
+static void BM_PtpJoint(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    protocol::PtpJoint::encode(w, POSITIONS);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_PtpJoint);
+
+static void BM_ExtPtpJointBaseline(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    baseline::extPtpJoint(w, POSITIONS);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_ExtPtpJointBaseline);
+
+static void BM_ExtPtpJoint(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    protocol::ExtPtpJoint::encode(w, POSITIONS);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_ExtPtpJoint);
+
+static void BM_QuinticSplinePointBaseline(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    baseline::quintSplinePoint(w, POSITIONS, VELOCITIES, ACCELERATIONS, 0.004);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_QuinticSplinePointBaseline);
+
+static void BM_QuinticSplinePoint(benchmark::State& state)
+{
+  Commandformat w;
+  for (auto _ : state)
+  {
+    protocol::QuinticSplinePoint::encode(w, POSITIONS, VELOCITIES, ACCELERATIONS, 0.004);
+    benchmark::DoNotOptimize(w);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_QuinticSplinePoint);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+
+#include <hiwin_robot_client_library/time_parameterization.hpp>
+
+#include "paths.hpp"
+
+using namespace hrsdk;
+
+static const size_t WAYPOINTS = 10000;
+
+// Reported next to the run time, so that a faster search is not mistaken for a slower trajectory
+static double duration(const TrajectoryBuffer& trajectory)
+{
+  return std::accumulate(trajectory.goal_times.begin(), trajectory.goal_times.end(), 0.0);
+}
+
+static void BM_ParameterizeSinusoid(benchmark::State& state)
+{
+  TrajectoryBuffer path;
+  paths::sinusoid(path, WAYPOINTS);
+  TrajectoryBuffer trajectory;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(parameterizeTrajectory(path, paths::limits(), trajectory));
+  }
+  state.counters["duration"] = duration(trajectory);
+}
+BENCHMARK(BM_ParameterizeSinusoid)->Unit(benchmark::kMillisecond);
+
+static void BM_ParameterizeRandomWalk(benchmark::State& state)
+{
+  TrajectoryBuffer path;
+  paths::randomWalk(path, WAYPOINTS, 1);
+  TrajectoryBuffer trajectory;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(parameterizeTrajectory(path, paths::limits(), trajectory));
+  }
+  state.counters["duration"] = duration(trajectory);
+}
+BENCHMARK(BM_ParameterizeRandomWalk)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,131 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_FAKE_CONTROLLER_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_FAKE_CONTROLLER_HPP_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+#include <hiwin_robot_client_library/protocol.hpp>
+
+/*!
+ * \brief Listening socket on localhost that stands in for a controller, driven step by step by the test.
+ *
+ * Frames are read and responses written from the test thread. Reads give up after a second, so
+ * a test that waits for a frame never sent fails instead of hanging.
+ */
+class FakeController
+{
+private:
+  int listen_fd_;
+  int fd_;
+
+public:
+  /*!
+   * \param backlog Connections the kernel completes before accept(). With 0 and one connection
+   *                made, further connects stay pending, as if the controller did not answer.
+   */
+  explicit FakeController(int backlog = 4) : listen_fd_(::socket(AF_INET, SOCK_STREAM, 0)), fd_(-1)
+  {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::listen(listen_fd_, backlog);
+  }
+
+  ~FakeController()
+  {
+    disconnect();
+    ::close(listen_fd_);
+  }
+
+  int port() const
+  {
+    sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length);
+    return ntohs(address.sin_port);
+  }
+
+  /// Takes the next connection the kernel completed
+  bool accept()
+  {
+    fd_ = ::accept(listen_fd_, nullptr, nullptr);
+    timeval timeout = { 1, 0 };
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd_ >= 0;
+  }
+
+  bool receive(hrsdk::Commandformat& frame)
+  {
+    uint8_t* data = reinterpret_cast<uint8_t*>(&frame);
+    size_t filled = 0;
+    while (filled < sizeof(frame))
+    {
+      ssize_t n = ::recv(fd_, data + filled, sizeof(frame) - filled, 0);
+      if (n <= 0)
+      {
+        return false;
+      }
+      filled += n;
+    }
+    return true;
+  }
+
+  bool send(const void* data, size_t size)
+  {
+    return ::send(fd_, data, size, MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+  }
+
+  bool respond(uint16_t cmd_id, uint16_t result)
+  {
+    hrsdk::Responseformat response = {};
+    response.cmd_id = cmd_id;
+    response.result = result;
+    return send(&response, sizeof(response));
+  }
+
+  /// Closes the accepted connection, as a controller going away does
+  void disconnect()
+  {
+    if (fd_ >= 0)
+    {
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+};
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_FAKE_CONTROLLER_HPP_
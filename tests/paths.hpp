@@ -0,0 +1,91 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_PATHS_HPP_
+#define HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_PATHS_HPP_
+
+#include <cmath>
+#include <random>
+
+#include <hiwin_robot_client_library/trajectory.hpp>
+
+// Dense joint-space paths for the time parameterization, six axes with limits of the usual size
+namespace paths
+{
+const size_t AXES = 6;
+
+inline hrsdk::JointLimits limits()
+{
+  hrsdk::JointLimits limits{};
+  limits.axis_count = AXES;
+  for (size_t axis = 0; axis < AXES; axis++)
+  {
+    limits.max_velocity[axis] = 2 + 0.3 * axis;
+    limits.max_acceleration[axis] = 8 + axis;
+    limits.max_jerk[axis] = 80 + 5 * axis;
+  }
+  return limits;
+}
+
+// Every axis swings at its own frequency, with steps small enough that segments last about a millisecond
+inline void sinusoid(hrsdk::TrajectoryBuffer& path, size_t points)
+{
+  path.resize(AXES, points);
+  for (size_t axis = 0; axis < AXES; axis++)
+  {
+    double position = 0;
+    for (size_t k = 0; k < points; k++)
+    {
+      position += 0.003 * std::sin(k * 0.002 * (axis + 1));
+      path.positions[axis][k] = position;
+    }
+  }
+}
+
+// Smoothed random steps, as a sampling-based planner would produce
+inline void randomWalk(hrsdk::TrajectoryBuffer& path, size_t points, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> noise(0, 0.002);
+  path.resize(AXES, points);
+  for (size_t axis = 0; axis < AXES; axis++)
+  {
+    double position = 0;
+    double step = 0;
+    for (size_t k = 0; k < points; k++)
+    {
+      step = 0.95 * step + noise(generator);
+      position += step;
+      path.positions[axis][k] = position;
+    }
+  }
+}
+
+}  // namespace paths
+
+#endif  // HIWIN_ROBOT_CLIENT_LIBRARY_TESTS_PATHS_HPP_
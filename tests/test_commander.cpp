@@ -0,0 +1,277 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include <hiwin_robot_client_library/commander.hpp>
+#include <hiwin_robot_client_library/socket/reactor.hpp>
+
+#include "fake_controller.hpp"
+
+using namespace hrsdk;
+
+namespace
+{
+const std::chrono::seconds WAIT(2);
+
+uint16_t id(CommandId command)
+{
+  return static_cast<uint16_t>(command);
+}
+
+bool ready(std::future<int>& future)
+{
+  return future.wait_for(WAIT) == std::future_status::ready;
+}
+
+/*
+ * A Commander connected to a FakeController, receiving either on its own thread or, with the
+ * parameter set, through a Reactor.
+ */
+class CommanderLoopback : public ::testing::TestWithParam<bool>
+{
+protected:
+  FakeController controller;
+  socket::Reactor reactor;
+  std::unique_ptr<Commander> commander;
+
+  void SetUp() override
+  {
+    commander.reset(new Commander("127.0.0.1", controller.port()));
+    if (GetParam())
+    {
+      ASSERT_TRUE(reactor.start());
+      commander->setReactor(&reactor);
+    }
+    commander->setPipelineDepth(4);
+    ASSERT_TRUE(commander->connect());
+    ASSERT_TRUE(controller.accept());
+  }
+
+  void TearDown() override
+  {
+    commander->disconnect();
+    commander.reset();
+    reactor.stop();
+  }
+
+  // Reads the next frame and checks which command it is
+  void expectFrame(CommandId command)
+  {
+    Commandformat frame;
+    ASSERT_TRUE(controller.receive(frame));
+    EXPECT_EQ(id(command), frame.cmd_id);
+  }
+};
+
+}  // namespace
+
+TEST_P(CommanderLoopback, MatchesResponsesInOrder)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  std::future<int> ratio = commander->setOverrideRatioAsync(20);
+  expectFrame(CommandId::SetPtpSpeed);
+  expectFrame(CommandId::SetOverRideRatio);
+
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 0));
+  ASSERT_TRUE(controller.respond(id(CommandId::SetOverRideRatio), 7));
+  ASSERT_TRUE(ready(speed));
+  ASSERT_TRUE(ready(ratio));
+  EXPECT_EQ(0, speed.get());
+  EXPECT_EQ(7, ratio.get());
+}
+
+TEST_P(CommanderLoopback, FailsRequestsAheadOfTheMatchingResponse)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  std::future<int> ratio = commander->setOverrideRatioAsync(20);
+  std::future<int> permissions = commander->getPermissionsAsync();
+  expectFrame(CommandId::SetPtpSpeed);
+  expectFrame(CommandId::SetOverRideRatio);
+  expectFrame(CommandId::GetPermissions);
+
+  // The controller answers in order, so a response to the second request means the first one's was lost
+  ASSERT_TRUE(controller.respond(id(CommandId::SetOverRideRatio), 0));
+  ASSERT_TRUE(ready(speed));
+  ASSERT_TRUE(ready(ratio));
+  EXPECT_EQ(COMMUNICATION_ERROR, speed.get());
+  EXPECT_EQ(0, ratio.get());
+  EXPECT_NE(std::future_status::ready, permissions.wait_for(std::chrono::milliseconds(50)));
+
+  ASSERT_TRUE(controller.respond(id(CommandId::GetPermissions), 0));
+  ASSERT_TRUE(ready(permissions));
+  EXPECT_EQ(0, permissions.get());
+}
+
+TEST_P(CommanderLoopback, DropsResponsesNobodyWaitsFor)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  expectFrame(CommandId::SetPtpSpeed);
+
+  // A known command that was never sent is skipped without failing anything
+  ASSERT_TRUE(controller.respond(id(CommandId::GetPtpSpeed), 0));
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 3));
+  ASSERT_TRUE(ready(speed));
+  EXPECT_EQ(3, speed.get());
+}
+
+TEST_P(CommanderLoopback, ResynchronisesAfterStrayBytes)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  expectFrame(CommandId::SetPtpSpeed);
+
+  // Three bytes of garbage shift the frame, so its id reads as an unknown command
+  const uint8_t garbage[3] = { 0xEE, 0xEE, 0xEE };
+  ASSERT_TRUE(controller.send(garbage, sizeof(garbage)));
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 4));
+  ASSERT_TRUE(ready(speed));
+  EXPECT_EQ(4, speed.get());
+
+  // The stream is aligned again for the next request
+  std::future<int> ratio = commander->setOverrideRatioAsync(20);
+  expectFrame(CommandId::SetOverRideRatio);
+  ASSERT_TRUE(controller.respond(id(CommandId::SetOverRideRatio), 0));
+  ASSERT_TRUE(ready(ratio));
+  EXPECT_EQ(0, ratio.get());
+}
+
+TEST_P(CommanderLoopback, FailsPendingRequestsWhenTheControllerGoes)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  std::future<int> ratio = commander->setOverrideRatioAsync(20);
+  expectFrame(CommandId::SetPtpSpeed);
+  expectFrame(CommandId::SetOverRideRatio);
+
+  controller.disconnect();
+  ASSERT_TRUE(ready(speed));
+  ASSERT_TRUE(ready(ratio));
+  EXPECT_EQ(COMMUNICATION_ERROR, speed.get());
+  EXPECT_EQ(COMMUNICATION_ERROR, ratio.get());
+
+  // Nothing is sent on a dead connection
+  std::future<int> late = commander->getPermissionsAsync();
+  ASSERT_TRUE(ready(late));
+  EXPECT_EQ(COMMUNICATION_ERROR, late.get());
+}
+
+TEST_P(CommanderLoopback, FailsPendingRequestsOnDisconnect)
+{
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  expectFrame(CommandId::SetPtpSpeed);
+
+  commander->disconnect();
+  ASSERT_TRUE(ready(speed));
+  EXPECT_EQ(COMMUNICATION_ERROR, speed.get());
+}
+
+TEST_P(CommanderLoopback, EmptyBatchIsReadyWithoutTraffic)
+{
+  std::future<int> empty = commander->sendFramesAsync(nullptr, 0);
+  ASSERT_EQ(std::future_status::ready, empty.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(0, empty.get());
+
+  // Nothing went out: the next frame the controller sees is the next request
+  std::future<int> speed = commander->setPtpSpeedAsync(10);
+  expectFrame(CommandId::SetPtpSpeed);
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 0));
+  ASSERT_TRUE(ready(speed));
+  EXPECT_EQ(0, speed.get());
+}
+
+TEST_P(CommanderLoopback, BatchReportsEveryResult)
+{
+  Commandformat frames[3];
+  protocol::SetPtpSpeed::encode(frames[0], 10);
+  protocol::SetOverRideRatio::encode(frames[1], 20);
+  protocol::GetPermissions::encode(frames[2]);
+  int results[3] = { -100, -100, -100 };
+
+  std::future<int> batch = commander->sendFramesAsync(frames, 3, results);
+  expectFrame(CommandId::SetPtpSpeed);
+  expectFrame(CommandId::SetOverRideRatio);
+  expectFrame(CommandId::GetPermissions);
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 0));
+  ASSERT_TRUE(controller.respond(id(CommandId::SetOverRideRatio), 6));
+  ASSERT_TRUE(controller.respond(id(CommandId::GetPermissions), 9));
+
+  // The future holds the first failure
+  ASSERT_TRUE(ready(batch));
+  EXPECT_EQ(6, batch.get());
+  EXPECT_EQ(0, results[0]);
+  EXPECT_EQ(6, results[1]);
+  EXPECT_EQ(9, results[2]);
+}
+
+TEST_P(CommanderLoopback, TrySendLeavesAFullPipelineAlone)
+{
+  Commandformat frames[3];
+  for (Commandformat& frame : frames)
+  {
+    protocol::GetPermissions::encode(frame);
+  }
+  std::future<int> batch = commander->sendFramesAsync(frames, 3);
+  for (int i = 0; i < 3; i++)
+  {
+    expectFrame(CommandId::GetPermissions);
+  }
+
+  // One slot is left, so two frames do not fit and neither goes out
+  Commandformat speed[2];
+  protocol::SetPtpSpeed::encode(speed[0], 10);
+  protocol::SetPtpSpeed::encode(speed[1], 20);
+  std::future<int> result;
+  EXPECT_FALSE(commander->trySendFramesAsync(speed, 2, result));
+  EXPECT_FALSE(result.valid());
+
+  ASSERT_TRUE(commander->trySendFramesAsync(speed, 1, result));
+  expectFrame(CommandId::SetPtpSpeed);
+  EXPECT_FALSE(commander->trySendFramesAsync(&speed[1], 1, result));
+
+  for (int i = 0; i < 3; i++)
+  {
+    ASSERT_TRUE(controller.respond(id(CommandId::GetPermissions), 0));
+  }
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 0));
+  ASSERT_TRUE(ready(batch));
+  ASSERT_TRUE(ready(result));
+  EXPECT_EQ(0, batch.get());
+  EXPECT_EQ(0, result.get());
+
+  // Once the responses free the pipeline, the refused frame goes out
+  ASSERT_TRUE(commander->trySendFramesAsync(&speed[1], 1, result));
+  expectFrame(CommandId::SetPtpSpeed);
+  ASSERT_TRUE(controller.respond(id(CommandId::SetPtpSpeed), 0));
+  ASSERT_TRUE(ready(result));
+  EXPECT_EQ(0, result.get());
+}
+
+INSTANTIATE_TEST_CASE_P(ReceiverThreadAndReactor, CommanderLoopback, ::testing::Bool());
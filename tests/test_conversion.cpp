@@ -0,0 +1,267 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <hiwin_robot_client_library/protocol.hpp>
+
+using namespace hrsdk;
+
+namespace
+{
+std::string printfFixed7(double value)
+{
+  char buffer[protocol::FIXED7_BUFFER_SIZE + 1];
+  snprintf(buffer, sizeof(buffer), "%.7f", value);
+  return buffer;
+}
+
+std::string fastFixed7(double value)
+{
+  char buffer[protocol::FIXED7_BUFFER_SIZE];
+  return std::string(buffer, protocol::formatFixed7(value, buffer));
+}
+
+uint64_t bits(double value)
+{
+  uint64_t result;
+  std::memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+double fromBits(uint64_t value)
+{
+  double result;
+  std::memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+// Radians whose millidegree product is exactly \p target, searched within a few ulps of the quotient
+bool exactRadians(double target, double& radians)
+{
+  const double quotient = target / 1000.0 / (180 / M_PI);
+  for (int offset = 0; offset <= 4; offset++)
+  {
+    double below = quotient;
+    double above = quotient;
+    for (int i = 0; i < offset; i++)
+    {
+      below = std::nextafter(below, -HUGE_VAL);
+      above = std::nextafter(above, HUGE_VAL);
+    }
+    if (below * (180 / M_PI) * 1000.0 == target)
+    {
+      radians = below;
+      return true;
+    }
+    if (above * (180 / M_PI) * 1000.0 == target)
+    {
+      radians = above;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs the batch conversion on every prefix length, so both the paired and the odd tail path see each value
+void expectBatchMatchesScalar(const std::vector<double>& radians)
+{
+  std::vector<int32_t> batch(radians.size());
+  for (size_t count = 0; count <= radians.size(); count++)
+  {
+    protocol::toMilliDegrees(radians.data(), batch.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+      ASSERT_EQ(protocol::toMilliDegrees(radians[i]), batch[i])
+          << "value " << radians[i] << " at " << i << " of " << count;
+    }
+  }
+}
+}  // namespace
+
+TEST(FormatFixed7, MatchesPrintfOnSpecialValues)
+{
+  const double values[] = { 0.0,
+                            -0.0,
+                            1e-8,
+                            -1e-8,
+                            4.9999999e-8,
+                            5e-8,
+                            -5e-8,
+                            1.5e-7,
+                            0.5,
+                            -0.5,
+                            1.0,
+                            180.0,
+                            -359.9999999,
+                            99999999999.99998,
+                            1e11,
+                            -1e11,
+                            1e15,
+                            1e300,
+                            std::numeric_limits<double>::max(),
+                            std::numeric_limits<double>::min(),
+                            std::numeric_limits<double>::denorm_min(),
+                            std::numeric_limits<double>::infinity(),
+                            -std::numeric_limits<double>::infinity(),
+                            std::numeric_limits<double>::quiet_NaN() };
+  for (double value : values)
+  {
+    EXPECT_EQ(printfFixed7(value), fastFixed7(value)) << "bits 0x" << std::hex << bits(value);
+  }
+}
+
+TEST(FormatFixed7, MatchesPrintfOnTies)
+{
+  // j / 256 with odd j is exact in binary and lands halfway between two 7th decimals
+  for (int64_t j = -200001; j <= 200001; j += 2)
+  {
+    const double value = static_cast<double>(j) / 256;
+    ASSERT_EQ(printfFixed7(value), fastFixed7(value)) << "value " << j << "/256";
+  }
+
+  // The same ties near the top of the fast path
+  for (int64_t j = 1; j < 20000; j += 2)
+  {
+    const double value = 99999999999.0 - static_cast<double>(j) / 256;
+    ASSERT_EQ(printfFixed7(value), fastFixed7(value)) << "value 99999999999 - " << j << "/256";
+  }
+}
+
+TEST(FormatFixed7, MatchesPrintfOnRandomValues)
+{
+  std::mt19937_64 rng(1807);
+  std::uniform_real_distribution<double> exponent(-12.0, 12.0);
+  for (size_t i = 0; i < 200000; i++)
+  {
+    // Log-uniform magnitudes and arbitrary bit patterns, NaNs and infinities included
+    const double value = (i % 2 ? 1.0 : -1.0) * std::pow(10.0, exponent(rng));
+    ASSERT_EQ(printfFixed7(value), fastFixed7(value)) << "bits 0x" << std::hex << bits(value);
+
+    const double pattern = fromBits(rng());
+    ASSERT_EQ(printfFixed7(pattern), fastFixed7(pattern)) << "bits 0x" << std::hex << bits(pattern);
+  }
+}
+
+TEST(MilliDegrees, BatchMatchesScalarOnTies)
+{
+  std::mt19937_64 rng(1808);
+  std::vector<double> radians;
+  for (int i = 0; i < 4000 && radians.size() < 101; i++)
+  {
+    const double target = static_cast<double>(static_cast<int64_t>(rng() % 2000000) - 1000000) + 0.5;
+    double value;
+    if (exactRadians(target, value))
+    {
+      radians.push_back(value);
+    }
+  }
+  // Without exact ties this test would prove nothing
+  ASSERT_GT(radians.size(), 50u);
+  expectBatchMatchesScalar(radians);
+}
+
+TEST(MilliDegrees, BatchMatchesScalarOnSpecialValues)
+{
+  std::vector<double> radians = { 0.0, -0.0, 1e-300, -1e-300, 4e-6, -4e-6, M_PI, -M_PI, 0.5, -0.5 };
+
+  // Products rounding to -0 and the edges of the int32 range
+  const double targets[] = { -0.25, -0.5, 0.5, 2147483646.5, 2147483647.0, -2147483647.5, -2147483648.0 };
+  for (double target : targets)
+  {
+    double value;
+    if (exactRadians(target, value))
+    {
+      radians.push_back(value);
+    }
+    radians.push_back(target / 1000.0 / (180 / M_PI));
+  }
+  radians.push_back(37480.0);  // Largest joint angles still inside int32 millidegrees
+  radians.push_back(-37480.0);
+  expectBatchMatchesScalar(radians);
+
+  int32_t zero[2];
+  const double zeros[2] = { -0.0, -1e-12 };
+  protocol::toMilliDegrees(zeros, zero, 2);
+  EXPECT_EQ(0, zero[0]);
+  EXPECT_EQ(0, zero[1]);
+}
+
+TEST(MilliDegrees, BatchMatchesScalarOnRandomValues)
+{
+  std::mt19937_64 rng(1809);
+  std::uniform_real_distribution<double> angle(-4 * M_PI, 4 * M_PI);
+  std::vector<double> radians(33);
+  for (size_t round = 0; round < 2000; round++)
+  {
+    for (double& value : radians)
+    {
+      value = angle(rng);
+    }
+    expectBatchMatchesScalar(radians);
+  }
+}
+
+TEST(MilliDegrees, BatchFromMatchesScalar)
+{
+  std::mt19937_64 rng(1810);
+  std::vector<int32_t> millidegrees = { 0,
+                                        1,
+                                        -1,
+                                        500,
+                                        -500,
+                                        180000,
+                                        -180000,
+                                        std::numeric_limits<int32_t>::max(),
+                                        std::numeric_limits<int32_t>::min() };
+  for (size_t i = 0; i < 10000; i++)
+  {
+    millidegrees.push_back(static_cast<int32_t>(rng()));
+  }
+
+  std::vector<double> batch(millidegrees.size());
+  for (size_t count : { size_t(0), size_t(1), size_t(2), size_t(3), size_t(8), size_t(9), millidegrees.size() })
+  {
+    std::fill(batch.begin(), batch.end(), 0.0);
+    protocol::fromMilliDegrees(millidegrees.data(), batch.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+      ASSERT_EQ(bits(protocol::fromMilliDegrees(millidegrees[i])), bits(batch[i]))
+          << "value " << millidegrees[i] << " at " << i << " of " << count;
+    }
+  }
+}
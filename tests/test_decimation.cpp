@@ -0,0 +1,190 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <hiwin_robot_client_library/decimation.hpp>
+#include <hiwin_robot_client_library/time_parameterization.hpp>
+
+#include "paths.hpp"
+
+using namespace hrsdk;
+
+namespace
+{
+const double TOLERANCE = 1e-4;
+
+// A dense timed trajectory with velocities and accelerations, as parameterizeTrajectory() gives them
+TrajectoryBuffer denseTrajectory()
+{
+  TrajectoryBuffer path;
+  TrajectoryBuffer trajectory;
+  paths::sinusoid(path, 2000);
+  parameterizeTrajectory(path, paths::limits(), trajectory);
+  return trajectory;
+}
+
+// Position of \p axis t seconds into the spline of \p type from point \p from to point \p to, span seconds apart
+double position(const TrajectoryBuffer& trajectory, TrajectoryType type, size_t axis, size_t from, size_t to,
+                double span, double t)
+{
+  const double p0 = trajectory.positions[axis][from];
+  const double h = trajectory.positions[axis][to] - p0;
+  const double v0 = trajectory.velocities[axis][from];
+  const double v1 = trajectory.velocities[axis][to];
+  const double a0 = trajectory.accelerations[axis][from];
+  const double a1 = trajectory.accelerations[axis][to];
+  const double s = t / span;
+
+  if (type == TrajectoryType::Linear)
+  {
+    return p0 + h * s;
+  }
+  if (type == TrajectoryType::Cubic)
+  {
+    // Hermite basis
+    return (2 * s * s * s - 3 * s * s + 1) * p0 + (s * s * s - 2 * s * s + s) * span * v0 +
+           (-2 * s * s * s + 3 * s * s) * (p0 + h) + (s * s * s - s * s) * span * v1;
+  }
+
+  const double c3 = (20 * h - (8 * v1 + 12 * v0) * span - (3 * a0 - a1) * span * span) / (2 * std::pow(span, 3));
+  const double c4 = (-30 * h + (14 * v1 + 16 * v0) * span + (3 * a0 - 2 * a1) * span * span) / (2 * std::pow(span, 4));
+  const double c5 = (12 * h - 6 * (v1 + v0) * span + (a1 - a0) * span * span) / (2 * std::pow(span, 5));
+  return p0 + v0 * t + 0.5 * a0 * t * t + c3 * std::pow(t, 3) + c4 * std::pow(t, 4) + c5 * std::pow(t, 5);
+}
+
+/*
+ * Re-fits the spline of \p type between each pair of consecutive kept points and checks every
+ * point dropped in between against it.
+ */
+::testing::AssertionResult droppedWithinTolerance(const TrajectoryBuffer& trajectory, TrajectoryType type,
+                                                  const std::vector<size_t>& kept)
+{
+  for (size_t j = 1; j < kept.size(); j++)
+  {
+    const size_t from = kept[j - 1];
+    const size_t to = kept[j];
+    double span = 0;
+    for (size_t m = from + 1; m <= to; m++)
+    {
+      span += trajectory.goal_times[m];
+    }
+
+    double t = 0;
+    for (size_t m = from + 1; m < to; m++)
+    {
+      t += trajectory.goal_times[m];
+      for (size_t axis = 0; axis < trajectory.axis_count; axis++)
+      {
+        const double error = std::fabs(position(trajectory, type, axis, from, to, span, t) -
+                                        trajectory.positions[axis][m]);
+        if (error > TOLERANCE * (1 + 1e-6))
+        {
+          return ::testing::AssertionFailure() << "point " << m << " of axis " << axis << " is off by " << error;
+        }
+      }
+    }
+  }
+  return ::testing::AssertionSuccess();
+}
+
+double total(const std::vector<double>& goal_times)
+{
+  return std::accumulate(goal_times.begin(), goal_times.end(), 0.0);
+}
+
+}  // namespace
+
+class Decimation : public ::testing::TestWithParam<TrajectoryType>
+{
+};
+
+TEST_P(Decimation, DroppedPointsStayWithinTolerance)
+{
+  const TrajectoryBuffer trajectory = denseTrajectory();
+  const std::vector<double> tolerances(trajectory.axis_count, TOLERANCE);
+
+  std::vector<size_t> kept;
+  ASSERT_TRUE(decimateTrajectory(trajectory, GetParam(), tolerances.data(), kept));
+  ASSERT_GE(kept.size(), 2u);
+  EXPECT_EQ(0u, kept.front());
+  EXPECT_EQ(trajectory.size() - 1, kept.back());
+  EXPECT_LT(kept.size(), trajectory.size());
+  EXPECT_TRUE(droppedWithinTolerance(trajectory, GetParam(), kept));
+}
+
+TEST_P(Decimation, MergedGoalTimesKeepTheDuration)
+{
+  const TrajectoryBuffer trajectory = denseTrajectory();
+  const std::vector<double> tolerances(trajectory.axis_count, TOLERANCE);
+
+  TrajectoryBuffer decimated;
+  std::vector<size_t> kept;
+  ASSERT_TRUE(decimateTrajectory(trajectory, GetParam(), tolerances.data(), decimated));
+  ASSERT_TRUE(decimateTrajectory(trajectory, GetParam(), tolerances.data(), kept));
+  ASSERT_EQ(kept.size(), decimated.size());
+  EXPECT_NEAR(total(trajectory.goal_times), total(decimated.goal_times), 1e-9);
+
+  // Each kept point carries the time since the one kept before it
+  for (size_t j = 0; j < kept.size(); j++)
+  {
+    double goal_time = 0;
+    for (size_t m = j > 0 ? kept[j - 1] + 1 : 0; m <= kept[j]; m++)
+    {
+      goal_time += trajectory.goal_times[m];
+    }
+    EXPECT_NEAR(goal_time, decimated.goal_times[j], 1e-12);
+    EXPECT_EQ(trajectory.positions[0][kept[j]], decimated.positions[0][j]);
+  }
+}
+
+TEST_P(Decimation, WorksInPlace)
+{
+  TrajectoryBuffer trajectory = denseTrajectory();
+  const std::vector<double> tolerances(trajectory.axis_count, TOLERANCE);
+
+  TrajectoryBuffer expected;
+  ASSERT_TRUE(decimateTrajectory(trajectory, GetParam(), tolerances.data(), expected));
+  ASSERT_TRUE(decimateTrajectory(trajectory, GetParam(), tolerances.data(), trajectory));
+
+  ASSERT_EQ(expected.size(), trajectory.size());
+  EXPECT_EQ(expected.goal_times, trajectory.goal_times);
+  for (size_t axis = 0; axis < expected.axis_count; axis++)
+  {
+    EXPECT_EQ(expected.positions[axis], trajectory.positions[axis]);
+    EXPECT_EQ(expected.velocities[axis], trajectory.velocities[axis]);
+    EXPECT_EQ(expected.accelerations[axis], trajectory.accelerations[axis]);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(SplineTypes, Decimation,
+                        ::testing::Values(TrajectoryType::Linear, TrajectoryType::Cubic, TrajectoryType::Quintic));
@@ -0,0 +1,205 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <hiwin_robot_client_library/online_trajectory.hpp>
+
+using namespace hrsdk;
+
+namespace
+{
+const size_t AXES = 6;
+const double CYCLE_TIME = 0.004;
+
+// Points per cycle at which the quintic is evaluated, the slack allowed on the limits, and the
+// most cycles any motion here may take
+const int SAMPLES = 50;
+const double TOLERANCE = 1e-6;
+const size_t MAX_CYCLES = 100000;
+
+JointLimits limits(double max_jerk)
+{
+  JointLimits limits{};
+  limits.axis_count = AXES;
+  for (size_t axis = 0; axis < AXES; axis++)
+  {
+    limits.max_velocity[axis] = 1 + 0.3 * axis;
+    limits.max_acceleration[axis] = 5 + axis;
+    limits.max_jerk[axis] = max_jerk + 10 * axis;
+  }
+  return limits;
+}
+
+// Checks the quintic the controller runs from \p from to \p to over one cycle against \p limits
+::testing::AssertionResult cycleWithinLimits(const TrajectoryPoint& from, const TrajectoryPoint& to,
+                                             const JointLimits& limits)
+{
+  const double t = CYCLE_TIME;
+  for (size_t axis = 0; axis < limits.axis_count; axis++)
+  {
+    const double v0 = from.velocities[axis];
+    const double a0 = from.accelerations[axis];
+    const double v1 = to.velocities[axis];
+    const double a1 = to.accelerations[axis];
+    const double h = to.positions[axis] - from.positions[axis];
+    const double c3 = (20 * h - (8 * v1 + 12 * v0) * t - (3 * a0 - a1) * t * t) / (2 * std::pow(t, 3));
+    const double c4 = (-30 * h + (14 * v1 + 16 * v0) * t + (3 * a0 - 2 * a1) * t * t) / (2 * std::pow(t, 4));
+    const double c5 = (12 * h - 6 * (v1 + v0) * t + (a1 - a0) * t * t) / (2 * std::pow(t, 5));
+
+    for (int i = 0; i <= SAMPLES; i++)
+    {
+      const double s = t * i / SAMPLES;
+      const double v = v0 + a0 * s + 3 * c3 * s * s + 4 * c4 * std::pow(s, 3) + 5 * c5 * std::pow(s, 4);
+      const double a = a0 + 6 * c3 * s + 12 * c4 * s * s + 20 * c5 * std::pow(s, 3);
+      const double j = 6 * c3 + 24 * c4 * s + 60 * c5 * s * s;
+      if (std::fabs(v) > limits.max_velocity[axis] * (1 + TOLERANCE) ||
+          std::fabs(a) > limits.max_acceleration[axis] * (1 + TOLERANCE) ||
+          std::fabs(j) > limits.max_jerk[axis] * (1 + TOLERANCE))
+      {
+        return ::testing::AssertionFailure() << "axis " << axis << " at " << s << " s: v " << v << " a " << a
+                                             << " j " << j;
+      }
+    }
+  }
+  return ::testing::AssertionSuccess();
+}
+
+// Runs \p generator until it settles, switching to \p retarget after \p retarget_cycle cycles
+::testing::AssertionResult runWithinLimits(OnlineTrajectoryGenerator& generator, const JointLimits& limits,
+                                           const double* retarget = nullptr, size_t retarget_cycle = 0)
+{
+  TrajectoryPoint previous = generator.getState();
+  TrajectoryPoint next;
+  for (size_t cycle = 1; generator.update(next); cycle++)
+  {
+    if (cycle > MAX_CYCLES)
+    {
+      return ::testing::AssertionFailure() << "not settled after " << MAX_CYCLES << " cycles";
+    }
+    ::testing::AssertionResult result = cycleWithinLimits(previous, next, limits);
+    if (!result)
+    {
+      return result << " in cycle " << cycle;
+    }
+    if (retarget && cycle == retarget_cycle)
+    {
+      generator.setTarget(retarget);
+    }
+    previous = next;
+  }
+  return ::testing::AssertionSuccess();
+}
+
+}  // namespace
+
+TEST(OnlineTrajectory, ArrivesAtRestWithinTheJerkLimit)
+{
+  const JointLimits jerk_limited = limits(80);
+  OnlineTrajectoryGenerator generator(jerk_limited, CYCLE_TIME);
+  generator.reset(TrajectoryPoint());
+
+  const double target[AXES] = { 1.0, 0, 0, 0, 0, 0 };
+  generator.setTarget(target);
+  EXPECT_TRUE(runWithinLimits(generator, jerk_limited));
+
+  const TrajectoryPoint& state = generator.getState();
+  EXPECT_EQ(1.0, state.positions[0]);
+  EXPECT_EQ(0.0, state.velocities[0]);
+  EXPECT_EQ(0.0, state.accelerations[0]);
+  EXPECT_TRUE(generator.isSettled());
+
+  TrajectoryPoint next;
+  EXPECT_FALSE(generator.update(next));
+}
+
+TEST(OnlineTrajectory, RandomTargetsKeepEveryCycleWithinTheLimits)
+{
+  std::mt19937 generator_seed(7);
+  std::uniform_real_distribution<double> unit(-1, 1);
+  const double scales[] = { 1e-5, 1e-3, 1.0 };
+  const double jerks[] = { 50, 5000 };
+
+  for (int trial = 0; trial < 60; trial++)
+  {
+    const JointLimits trial_limits = limits(jerks[trial % 2]);
+    const double scale = scales[trial % 3];
+    OnlineTrajectoryGenerator generator(trial_limits, CYCLE_TIME);
+    generator.reset(TrajectoryPoint());
+
+    double target[AXES];
+    double retarget[AXES];
+    for (size_t axis = 0; axis < AXES; axis++)
+    {
+      target[axis] = scale * unit(generator_seed);
+      retarget[axis] = scale * unit(generator_seed);
+    }
+    generator.setTarget(target);
+
+    // Every other pair of trials changes its mind in the first cycles, while the axes are still moving
+    const bool retargeted = trial % 4 >= 2;
+    EXPECT_TRUE(runWithinLimits(generator, trial_limits, retargeted ? retarget : nullptr, 1 + trial % 2))
+        << "trial " << trial;
+    for (size_t axis = 0; axis < AXES; axis++)
+    {
+      EXPECT_EQ(retargeted ? retarget[axis] : target[axis], generator.getState().positions[axis]) << "trial " << trial;
+    }
+  }
+}
+
+TEST(OnlineTrajectory, IgnoresAxesBeyondTheMaximum)
+{
+  JointLimits too_many = limits(50);
+  too_many.axis_count = TRAJECTORY_MAX_AXES + 7;
+  for (size_t axis = AXES; axis < TRAJECTORY_MAX_AXES; axis++)
+  {
+    too_many.max_velocity[axis] = 1;
+    too_many.max_acceleration[axis] = 5;
+    too_many.max_jerk[axis] = 50;
+  }
+  OnlineTrajectoryGenerator generator(too_many, CYCLE_TIME);
+  generator.reset(TrajectoryPoint());
+
+  double target[TRAJECTORY_MAX_AXES];
+  std::fill(target, target + TRAJECTORY_MAX_AXES, 0.01);
+  generator.setTarget(target);
+
+  TrajectoryPoint next;
+  for (size_t cycle = 0; cycle < MAX_CYCLES && generator.update(next); cycle++)
+  {
+  }
+  EXPECT_TRUE(generator.isSettled());
+  for (size_t axis = 0; axis < TRAJECTORY_MAX_AXES; axis++)
+  {
+    EXPECT_EQ(0.01, generator.getState().positions[axis]);
+  }
+}
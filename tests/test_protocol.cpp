@@ -0,0 +1,251 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <hiwin_robot_client_library/commander.hpp>
+
+#include "baseline_encoders.hpp"
+
+using namespace hrsdk;
+
+namespace
+{
+const size_t ROUNDS = 2000;
+
+::testing::AssertionResult sameFrame(const Commandformat& expected, const Commandformat& actual)
+{
+  if (expected.cmd_id != actual.cmd_id)
+  {
+    return ::testing::AssertionFailure() << "cmd_id " << expected.cmd_id << " != " << actual.cmd_id;
+  }
+  for (size_t i = 0; i < COMMAND_PARAM_WORDS; i++)
+  {
+    if (expected.param[i] != actual.param[i])
+    {
+      return ::testing::AssertionFailure() << "param[" << i << "] " << expected.param[i] << " != " << actual.param[i];
+    }
+  }
+  return ::testing::AssertionSuccess();
+}
+
+// Frames start out dirty so that words a layout forgets to write show up as differences
+Commandformat dirtyFrame()
+{
+  Commandformat w;
+  std::memset(&w, 0xA5, sizeof(w));
+  return w;
+}
+
+class ProtocolEncoding : public ::testing::Test
+{
+protected:
+  std::mt19937_64 rng_;
+
+  ProtocolEncoding() : rng_(20241017)
+  {
+  }
+
+  // Mostly joint-sized angles, with some exact values, halfway millidegrees and large magnitudes mixed in
+  double angle()
+  {
+    static const double SPECIAL[] = { 0.0, -0.0, 1e-12, -1e-12, M_PI, -M_PI, 100.0, -100.0, 1e4 };
+    switch (rng_() % 8)
+    {
+      case 0:
+        return SPECIAL[rng_() % (sizeof(SPECIAL) / sizeof(SPECIAL[0]))];
+      case 1:
+        return (static_cast<int>(rng_() % 720000) - 360000 + 0.5) / 1000.0 * (M_PI / 180);
+      default:
+        return std::uniform_real_distribution<double>(-2 * M_PI, 2 * M_PI)(rng_);
+    }
+  }
+
+  void angles(double* values, size_t count)
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      values[i] = angle();
+    }
+  }
+
+  double seconds()
+  {
+    return std::uniform_real_distribution<double>(0.0, 60.0)(rng_);
+  }
+};
+
+template <typename Cmd>
+void expectCmdOnly(CommandId id)
+{
+  Commandformat expected, actual = dirtyFrame();
+  baseline::cmdOnly(expected, id);
+  Cmd::encode(actual);
+  EXPECT_TRUE(sameFrame(expected, actual)) << "command 0x" << std::hex << static_cast<int>(id);
+}
+}  // namespace
+
+TEST_F(ProtocolEncoding, QueriesWithoutParameters)
+{
+  expectCmdOnly<protocol::GetServoAmp>(CommandId::GetServoAmp);
+  expectCmdOnly<protocol::GetActualRPM>(CommandId::GetActualRPM);
+  expectCmdOnly<protocol::GetActualCurrent>(CommandId::GetActualCurrent);
+  expectCmdOnly<protocol::GetExtActualRPM>(CommandId::GetExtActualRPM);
+  expectCmdOnly<protocol::GetExtActualPosition>(CommandId::GetExtActualPosition);
+  expectCmdOnly<protocol::GetMotionState>(CommandId::GetMotionState);
+  expectCmdOnly<protocol::GetErrorCode>(CommandId::GetErrorCode);
+  expectCmdOnly<protocol::GetHrssMode>(CommandId::GetHrssMode);
+  expectCmdOnly<protocol::MotionAbort>(CommandId::MotionAbort);
+  expectCmdOnly<protocol::ControllerReset>(CommandId::ControllerReset);
+  expectCmdOnly<protocol::GetPtpSpeed>(CommandId::GetPtpSpeed);
+  expectCmdOnly<protocol::GetOverRideRatio>(CommandId::GetOverRideRatio);
+  expectCmdOnly<protocol::GetRobotMode>(CommandId::GetRobotMode);
+  expectCmdOnly<protocol::GetRobotVersion>(CommandId::GetRobotVersion);
+  expectCmdOnly<protocol::GetHRSSVersion>(CommandId::GetHRSSVersion);
+}
+
+TEST_F(ProtocolEncoding, FixedParameters)
+{
+  Commandformat expected, actual = dirtyFrame();
+  baseline::getPermissions(expected);
+  protocol::GetPermissions::encode(actual);
+  EXPECT_TRUE(sameFrame(expected, actual));
+
+  actual = dirtyFrame();
+  baseline::getActualPosition(expected);
+  protocol::GetActualPosition::encode(actual);
+  EXPECT_TRUE(sameFrame(expected, actual));
+}
+
+TEST_F(ProtocolEncoding, WordParameters)
+{
+  Commandformat expected, actual;
+  for (int level = 0; level <= static_cast<int>(LogLevels::Save); level++)
+  {
+    actual = dirtyFrame();
+    baseline::setLogLevel(expected, static_cast<LogLevels>(level));
+    protocol::SetLogLevel::encode(actual, static_cast<LogLevels>(level));
+    EXPECT_TRUE(sameFrame(expected, actual));
+  }
+  for (int enable = 0; enable < 2; enable++)
+  {
+    actual = dirtyFrame();
+    baseline::setServoAmpState(expected, enable != 0);
+    protocol::SetServoAmp::encode(actual, enable != 0);
+    EXPECT_TRUE(sameFrame(expected, actual));
+  }
+  for (int mode = 0; mode < 2; mode++)
+  {
+    actual = dirtyFrame();
+    baseline::setRobotMode(expected, static_cast<ControlMode>(mode));
+    protocol::SetRobotMode::encode(actual, static_cast<ControlMode>(mode));
+    EXPECT_TRUE(sameFrame(expected, actual));
+  }
+  for (int ratio = 0; ratio <= 100; ratio++)
+  {
+    actual = dirtyFrame();
+    baseline::setPtpSpeed(expected, ratio);
+    protocol::SetPtpSpeed::encode(actual, ratio);
+    EXPECT_TRUE(sameFrame(expected, actual));
+
+    actual = dirtyFrame();
+    baseline::setOverrideRatio(expected, ratio);
+    protocol::SetOverRideRatio::encode(actual, ratio);
+    EXPECT_TRUE(sameFrame(expected, actual));
+  }
+}
+
+TEST_F(ProtocolEncoding, AsciiPtp)
+{
+  double positions[9];
+  Commandformat expected, actual;
+  for (size_t round = 0; round < ROUNDS; round++)
+  {
+    angles(positions, 9);
+
+    actual = dirtyFrame();
+    baseline::ptpJoint(expected, positions);
+    protocol::PtpJoint::encode(actual, positions);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+
+    actual = dirtyFrame();
+    baseline::extPtpJoint(expected, positions);
+    protocol::ExtPtpJoint::encode(actual, positions);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+  }
+}
+
+TEST_F(ProtocolEncoding, BinaryPtp)
+{
+  double positions[6];
+  Commandformat expected, actual;
+  for (size_t round = 0; round < ROUNDS; round++)
+  {
+    angles(positions, 6);
+    double acc_time = seconds();
+    double ratio = std::uniform_real_distribution<double>(0.0, 100.0)(rng_);
+
+    actual = dirtyFrame();
+    baseline::ptpJoint(expected, positions, acc_time, ratio);
+    protocol::PtpJointWithVelocity::encode(actual, acc_time, ratio, positions);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+  }
+}
+
+TEST_F(ProtocolEncoding, SplinePoints)
+{
+  double positions[9], velocities[9], accelerations[9];
+  Commandformat expected, actual;
+  for (size_t round = 0; round < ROUNDS; round++)
+  {
+    angles(positions, 9);
+    angles(velocities, 9);
+    angles(accelerations, 9);
+    double goal_time = seconds();
+
+    actual = dirtyFrame();
+    baseline::linearSplinePoint(expected, positions, goal_time);
+    protocol::LinearSplinePoint::encode(actual, positions, goal_time);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+
+    actual = dirtyFrame();
+    baseline::cubicSplinePoint(expected, positions, velocities, goal_time);
+    protocol::CubicSplinePoint::encode(actual, positions, velocities, goal_time);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+
+    actual = dirtyFrame();
+    baseline::quintSplinePoint(expected, positions, velocities, accelerations, goal_time);
+    protocol::QuinticSplinePoint::encode(actual, positions, velocities, accelerations, goal_time);
+    ASSERT_TRUE(sameFrame(expected, actual)) << "round " << round;
+  }
+}
@@ -0,0 +1,181 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <hiwin_robot_client_library/robot_fleet.hpp>
+#include <hiwin_robot_client_library/socket/reactor.hpp>
+#include <hiwin_robot_client_library/socket/tcp_client.hpp>
+
+#include "fake_controller.hpp"
+
+using namespace hrsdk;
+using namespace hrsdk::socket;
+
+namespace
+{
+const std::chrono::milliseconds CONNECT_TIMEOUT(200);
+
+bool connect(TCPClient& client, int port)
+{
+  TCPClient* clients[] = { &client };
+  return client.beginConnect("127.0.0.1", port) && TCPClient::connectAll(clients, 1, std::chrono::seconds(1));
+}
+
+/*
+ * A listener that takes no more connections: with a backlog of 0 the kernel completes one
+ * connect, which is never accepted, and leaves the ones after it pending, as an unreachable
+ * controller does.
+ */
+class SaturatedListener
+{
+private:
+  FakeController listener_;
+  TCPClient filler_;
+
+public:
+  SaturatedListener() : listener_(0)
+  {
+    connect(filler_, listener_.port());
+  }
+
+  int port() const
+  {
+    return listener_.port();
+  }
+};
+
+/*
+ * Counts its read events and, on the first, drops another client from the reactor and
+ * destroys it, as a robot torn down from a callback would be.
+ */
+class DroppingClient : public TCPClient
+{
+public:
+  Reactor* reactor = nullptr;
+  std::unique_ptr<TCPClient>* victim = nullptr;
+  std::atomic<int>* reads = nullptr;
+
+  void onReadable() override
+  {
+    TCPClient::onReadable();
+    if ((*reads)++ == 0 && victim->get())
+    {
+      reactor->remove(victim->get());
+      victim->reset();
+    }
+  }
+};
+
+}  // namespace
+
+TEST(Reactor, DropsEventsOfAClientRemovedDuringDispatch)
+{
+  FakeController controllers[2];
+  std::unique_ptr<TCPClient> clients[2];
+  std::atomic<int> reads[2];
+  Reactor reactor;
+
+  for (int i = 0; i < 2; i++)
+  {
+    DroppingClient* client = new DroppingClient;
+    client->reactor = &reactor;
+    client->victim = &clients[1 - i];
+    client->reads = &reads[i];
+    reads[i] = 0;
+    clients[i].reset(client);
+    ASSERT_TRUE(connect(*client, controllers[i].port()));
+    ASSERT_TRUE(controllers[i].accept());
+    ASSERT_TRUE(reactor.add(client));
+  }
+
+  // Both sockets are readable before the reactor first waits, so one epoll_wait() returns both
+  ASSERT_TRUE(controllers[0].respond(0, 0));
+  ASSERT_TRUE(controllers[1].respond(0, 0));
+  ASSERT_TRUE(reactor.start());
+
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (reads[0] + reads[1] == 0 && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  reactor.stop();
+
+  // Whichever ran first removed the other, whose pending event must not reach it
+  EXPECT_EQ(1, reads[0] + reads[1]);
+  EXPECT_NE(clients[0].get() == nullptr, clients[1].get() == nullptr);
+}
+
+TEST(TCPClient, ConnectAllWaitsOneDeadlineForAllClients)
+{
+  SaturatedListener unreachable;
+  FakeController reachable;
+
+  const size_t HUNG = 4;
+  TCPClient clients[HUNG + 1];
+  std::vector<TCPClient*> pointers;
+  for (size_t i = 0; i < HUNG; i++)
+  {
+    ASSERT_TRUE(clients[i].beginConnect("127.0.0.1", unreachable.port()));
+    pointers.push_back(&clients[i]);
+  }
+  ASSERT_TRUE(clients[HUNG].beginConnect("127.0.0.1", reachable.port()));
+  pointers.push_back(&clients[HUNG]);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(TCPClient::connectAll(pointers.data(), pointers.size(), CONNECT_TIMEOUT));
+  std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_LT(elapsed, 2 * CONNECT_TIMEOUT);
+  for (size_t i = 0; i < HUNG; i++)
+  {
+    EXPECT_EQ(SocketState::Invalid, clients[i].getState());
+  }
+  EXPECT_EQ(SocketState::Connected, clients[HUNG].getState());
+}
+
+TEST(RobotFleet, UnreachableRobotsCostOneTimeoutTogether)
+{
+  SaturatedListener unreachable;
+  RobotFleet fleet(1);
+  for (int i = 0; i < 3; i++)
+  {
+    fleet.addRobot("127.0.0.1", unreachable.port(), unreachable.port(), unreachable.port());
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  EXPECT_EQ(0u, fleet.connectAll(CONNECT_TIMEOUT));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 2 * CONNECT_TIMEOUT);
+}
@@ -0,0 +1,149 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <hiwin_robot_client_library/time_parameterization.hpp>
+
+#include "paths.hpp"
+
+using namespace hrsdk;
+
+namespace
+{
+// Points per segment at which the quintic is evaluated, and the slack allowed on the limits
+const int SAMPLES = 200;
+const double TOLERANCE = 1e-6;
+
+// The goal time the controller receives, see protocol::Milli
+double wireTime(double goal_time)
+{
+  return std::round(goal_time * 1000) / 1000;
+}
+
+/*
+ * Evaluates every segment of \p trajectory as the controller runs it, from the previous waypoint
+ * (or the first one of \p path at rest) over the goal time in whole milliseconds, and checks it
+ * against \p limits.
+ */
+::testing::AssertionResult withinLimits(const TrajectoryBuffer& path, const TrajectoryBuffer& trajectory,
+                                        const JointLimits& limits)
+{
+  for (size_t k = 0; k < trajectory.size(); k++)
+  {
+    const double t = wireTime(trajectory.goal_times[k]);
+    if (t < 0.001 || std::fabs(trajectory.goal_times[k] - t) > 1e-9)
+    {
+      return ::testing::AssertionFailure() << "segment " << k << " lasts " << trajectory.goal_times[k] << " s";
+    }
+
+    for (size_t axis = 0; axis < trajectory.axis_count; axis++)
+    {
+      const double p0 = k > 0 ? trajectory.positions[axis][k - 1] : path.positions[axis][0];
+      const double v0 = k > 0 ? trajectory.velocities[axis][k - 1] : 0;
+      const double a0 = k > 0 ? trajectory.accelerations[axis][k - 1] : 0;
+      const double v1 = trajectory.velocities[axis][k];
+      const double a1 = trajectory.accelerations[axis][k];
+      const double h = trajectory.positions[axis][k] - p0;
+      const double c3 = (20 * h - (8 * v1 + 12 * v0) * t - (3 * a0 - a1) * t * t) / (2 * std::pow(t, 3));
+      const double c4 = (-30 * h + (14 * v1 + 16 * v0) * t + (3 * a0 - 2 * a1) * t * t) / (2 * std::pow(t, 4));
+      const double c5 = (12 * h - 6 * (v1 + v0) * t + (a1 - a0) * t * t) / (2 * std::pow(t, 5));
+
+      for (int i = 0; i <= SAMPLES; i++)
+      {
+        const double s = t * i / SAMPLES;
+        const double v = v0 + a0 * s + 3 * c3 * s * s + 4 * c4 * std::pow(s, 3) + 5 * c5 * std::pow(s, 4);
+        const double a = a0 + 6 * c3 * s + 12 * c4 * s * s + 20 * c5 * std::pow(s, 3);
+        const double j = 6 * c3 + 24 * c4 * s + 60 * c5 * s * s;
+        if (std::fabs(v) > limits.max_velocity[axis] * (1 + TOLERANCE) ||
+            std::fabs(a) > limits.max_acceleration[axis] * (1 + TOLERANCE) ||
+            std::fabs(j) > limits.max_jerk[axis] * (1 + TOLERANCE))
+        {
+          return ::testing::AssertionFailure() << "segment " << k << " axis " << axis << " at " << s << " s: v " << v
+                                               << " a " << a << " j " << j;
+        }
+      }
+    }
+  }
+  return ::testing::AssertionSuccess();
+}
+
+}  // namespace
+
+TEST(TimeParameterization, RejectsMismatchedPaths)
+{
+  TrajectoryBuffer path;
+  TrajectoryBuffer trajectory;
+  path.resize(paths::AXES, 1);
+  EXPECT_FALSE(parameterizeTrajectory(path, paths::limits(), trajectory));
+
+  path.resize(paths::AXES - 1, 10);
+  EXPECT_FALSE(parameterizeTrajectory(path, paths::limits(), trajectory));
+}
+
+TEST(TimeParameterization, SingleSegmentTakesTheRestTimeInWholeMilliseconds)
+{
+  TrajectoryBuffer path;
+  path.resize(paths::AXES, 2);
+  path.positions[0][1] = 1.0;
+
+  TrajectoryBuffer trajectory;
+  ASSERT_TRUE(parameterizeTrajectory(path, paths::limits(), trajectory));
+  ASSERT_EQ(1u, trajectory.size());
+
+  // The velocity bound dominates a 1 rad move: 1.875 / 2 s, rounded up
+  EXPECT_DOUBLE_EQ(0.938, trajectory.goal_times[0]);
+  EXPECT_TRUE(withinLimits(path, trajectory, paths::limits()));
+}
+
+TEST(TimeParameterization, DenseSinusoidFitsOnWholeMilliseconds)
+{
+  TrajectoryBuffer path;
+  paths::sinusoid(path, 10000);
+
+  TrajectoryBuffer trajectory;
+  ASSERT_TRUE(parameterizeTrajectory(path, paths::limits(), trajectory));
+  ASSERT_EQ(path.size() - 1, trajectory.size());
+  EXPECT_TRUE(withinLimits(path, trajectory, paths::limits()));
+}
+
+TEST(TimeParameterization, RandomWalksFitOnWholeMilliseconds)
+{
+  for (unsigned seed = 1; seed <= 5; seed++)
+  {
+    TrajectoryBuffer path;
+    paths::randomWalk(path, 2000, seed);
+
+    TrajectoryBuffer trajectory;
+    ASSERT_TRUE(parameterizeTrajectory(path, paths::limits(), trajectory));
+    EXPECT_TRUE(withinLimits(path, trajectory, paths::limits())) << "seed " << seed;
+  }
+}
@@ -0,0 +1,277 @@
+// Copyright 2024 HIWIN Technologies Corp.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    * Redistributions of source code must retain the above copyright
+//      notice, this list of conditions and the following disclaimer.
+//
+//    * Redistributions in binary form must reproduce the above copyright
+//      notice, this list of conditions and the following disclaimer in the
+//      documentation and/or other materials provided with the distribution.
+//
+//    * Neither the name of the {copyright_holder} nor the names of its
+//      contributors may be used to endorse or promote products derived from
+//      this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <hiwin_robot_client_library/trajectory_validation.hpp>
+
+using namespace hrsdk;
+
+namespace
+{
+const size_t AXES = 6;
+const double GOAL_TIME = 0.01;
+const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+JointLimits limits()
+{
+  JointLimits limits{};
+  limits.axis_count = AXES;
+  for (size_t axis = 0; axis < AXES; axis++)
+  {
+    limits.min_position[axis] = -3;
+    limits.max_position[axis] = 3;
+    limits.max_velocity[axis] = 2;
+    limits.max_acceleration[axis] = 10;
+    limits.max_jerk[axis] = 100;
+  }
+  return limits;
+}
+
+// A trajectory that keeps every limit, each step using at most half of what the limits allow
+TrajectoryBuffer validTrajectory(size_t points, std::mt19937& generator)
+{
+  std::uniform_real_distribution<double> share(-0.5, 0.5);
+  TrajectoryBuffer trajectory;
+  trajectory.resize(AXES, points);
+  for (size_t k = 0; k < points; k++)
+  {
+    trajectory.goal_times[k] = GOAL_TIME;
+    for (size_t axis = 0; axis < AXES; axis++)
+    {
+      const double q = k > 0 ? trajectory.positions[axis][k - 1] : 0;
+      const double v = k > 0 ? trajectory.velocities[axis][k - 1] : 0;
+      const double a = k > 0 ? trajectory.accelerations[axis][k - 1] : 0;
+      trajectory.positions[axis][k] = std::max(-2.5, std::min(2.5, q + share(generator) * 2 * GOAL_TIME));
+      trajectory.velocities[axis][k] = std::max(-1.5, std::min(1.5, v + share(generator) * 10 * GOAL_TIME));
+      trajectory.accelerations[axis][k] = std::max(-8.0, std::min(8.0, a + share(generator) * 100 * GOAL_TIME));
+    }
+  }
+  return trajectory;
+}
+
+/*
+ * The rules of validateTrajectory() checked one point and one axis at a time, lowest index first
+ * and at equal index lowest axis first, without any of its shortcuts
+ */
+TrajectoryViolation reference(const TrajectoryBuffer& trajectory, TrajectoryType type, const JointLimits& limits)
+{
+  const bool velocity = type != TrajectoryType::Linear;
+  const bool acceleration = type == TrajectoryType::Quintic;
+  for (size_t k = 0; k < trajectory.size(); k++)
+  {
+    for (size_t axis = 0; axis < std::min(trajectory.axis_count, limits.axis_count); axis++)
+    {
+      const double q = trajectory.positions[axis][k];
+      const double v = trajectory.velocities[axis][k];
+      const double a = trajectory.accelerations[axis][k];
+      const double t = trajectory.goal_times[k];
+      LimitViolation violation = LimitViolation::None;
+      if (limits.min_position[axis] != limits.max_position[axis] &&
+          !(q >= limits.min_position[axis] && q <= limits.max_position[axis]))
+      {
+        violation = LimitViolation::Position;
+      }
+      else if (velocity && !(std::fabs(v) <= limits.max_velocity[axis]))
+      {
+        violation = LimitViolation::Velocity;
+      }
+      else if (acceleration && !(std::fabs(a) <= limits.max_acceleration[axis]))
+      {
+        violation = LimitViolation::Acceleration;
+      }
+      else if (k > 0 && !(std::fabs(q - trajectory.positions[axis][k - 1]) <= limits.max_velocity[axis] * t))
+      {
+        violation = LimitViolation::PositionStep;
+      }
+      else if (k > 0 && velocity &&
+               !(std::fabs(v - trajectory.velocities[axis][k - 1]) <= limits.max_acceleration[axis] * t))
+      {
+        violation = LimitViolation::VelocityStep;
+      }
+      else if (k > 0 && acceleration &&
+               !(std::fabs(a - trajectory.accelerations[axis][k - 1]) <= limits.max_jerk[axis] * t))
+      {
+        violation = LimitViolation::AccelerationStep;
+      }
+
+      if (violation != LimitViolation::None)
+      {
+        return TrajectoryViolation{ violation, k, axis };
+      }
+    }
+  }
+  return TrajectoryViolation{ LimitViolation::None, trajectory.size(), 0 };
+}
+
+::testing::AssertionResult matchesReference(const TrajectoryBuffer& trajectory, TrajectoryType type,
+                                            const JointLimits& limits)
+{
+  TrajectoryViolation found;
+  const bool valid = validateTrajectory(trajectory, type, limits, found);
+  const TrajectoryViolation expected = reference(trajectory, type, limits);
+  if (valid != (expected.violation == LimitViolation::None) || found.violation != expected.violation ||
+      found.index != expected.index || (!valid && found.axis != expected.axis))
+  {
+    return ::testing::AssertionFailure()
+           << "found limit " << static_cast<int>(found.violation) << " at point " << found.index << " axis "
+           << found.axis << ", expected limit " << static_cast<int>(expected.violation) << " at point "
+           << expected.index << " axis " << expected.axis;
+  }
+  return ::testing::AssertionSuccess();
+}
+
+// Value of one entry the test breaks a limit with
+double& entry(TrajectoryBuffer& trajectory, int array, size_t axis, size_t k)
+{
+  switch (array)
+  {
+    case 0:
+      return trajectory.positions[axis][k];
+    case 1:
+      return trajectory.velocities[axis][k];
+    case 2:
+      return trajectory.accelerations[axis][k];
+    default:
+      return trajectory.goal_times[k];
+  }
+}
+
+}  // namespace
+
+class TrajectoryValidation : public ::testing::TestWithParam<TrajectoryType>
+{
+};
+
+TEST_P(TrajectoryValidation, AcceptsTrajectoriesWithinTheLimits)
+{
+  std::mt19937 generator(1);
+  for (size_t points = 0; points < 20; points++)
+  {
+    TrajectoryBuffer trajectory = validTrajectory(points, generator);
+    TrajectoryViolation violation;
+    EXPECT_TRUE(validateTrajectory(trajectory, GetParam(), limits(), violation)) << points << " points";
+    EXPECT_EQ(points, violation.index);
+  }
+}
+
+TEST_P(TrajectoryValidation, ReportsTheEarliestPointThenTheLowestAxis)
+{
+  std::mt19937 generator(2);
+  TrajectoryBuffer trajectory = validTrajectory(16, generator);
+  trajectory.positions[1][9] = 5;
+  trajectory.positions[4][6] = 5;
+  trajectory.positions[2][6] = -5;
+
+  TrajectoryViolation violation;
+  EXPECT_FALSE(validateTrajectory(trajectory, GetParam(), limits(), violation));
+  EXPECT_EQ(LimitViolation::Position, violation.violation);
+  EXPECT_EQ(6u, violation.index);
+  EXPECT_EQ(2u, violation.axis);
+  EXPECT_TRUE(matchesReference(trajectory, GetParam(), limits()));
+}
+
+TEST_P(TrajectoryValidation, NotANumberBreaksEveryLimit)
+{
+  std::mt19937 generator(3);
+  for (int array = 0; array < 4; array++)
+  {
+    // Even and odd indices land in either lane of a pair, the last ones in the scalar tail
+    for (size_t k = 0; k < 11; k++)
+    {
+      TrajectoryBuffer trajectory = validTrajectory(11, generator);
+      entry(trajectory, array, k % AXES, k) = NOT_A_NUMBER;
+      EXPECT_TRUE(matchesReference(trajectory, GetParam(), limits())) << "array " << array << " point " << k;
+    }
+  }
+}
+
+TEST_P(TrajectoryValidation, ChecksTheOddPointAfterThePairs)
+{
+  std::mt19937 generator(4);
+  for (size_t points = 2; points < 12; points++)
+  {
+    TrajectoryBuffer trajectory = validTrajectory(points, generator);
+    trajectory.positions[AXES - 1][points - 1] += 1;
+    TrajectoryViolation violation;
+    EXPECT_FALSE(validateTrajectory(trajectory, GetParam(), limits(), violation)) << points << " points";
+    EXPECT_EQ(points - 1, violation.index);
+    EXPECT_EQ(AXES - 1, violation.axis);
+    EXPECT_TRUE(matchesReference(trajectory, GetParam(), limits())) << points << " points";
+  }
+}
+
+TEST_P(TrajectoryValidation, EqualPositionLimitsLeaveThePositionFree)
+{
+  std::mt19937 generator(5);
+  JointLimits unlimited = limits();
+  unlimited.min_position[3] = unlimited.max_position[3] = 0;
+
+  TrajectoryBuffer trajectory = validTrajectory(9, generator);
+  for (size_t k = 0; k < trajectory.size(); k++)
+  {
+    trajectory.positions[3][k] += 100;
+  }
+  TrajectoryViolation violation;
+  EXPECT_TRUE(validateTrajectory(trajectory, GetParam(), unlimited, violation));
+  EXPECT_TRUE(matchesReference(trajectory, GetParam(), unlimited));
+
+  // The step limit still applies
+  trajectory.positions[3][7] += 1;
+  EXPECT_FALSE(validateTrajectory(trajectory, GetParam(), unlimited, violation));
+  EXPECT_EQ(LimitViolation::PositionStep, violation.violation);
+  EXPECT_EQ(7u, violation.index);
+  EXPECT_TRUE(matchesReference(trajectory, GetParam(), unlimited));
+}
+
+TEST_P(TrajectoryValidation, MatchesThePointByPointCheckOnRandomViolations)
+{
+  std::mt19937 generator(6);
+  std::uniform_int_distribution<int> array(0, 3);
+  std::uniform_int_distribution<int> violations(1, 3);
+  std::uniform_real_distribution<double> value(-20, 20);
+  for (int trial = 0; trial < 2000; trial++)
+  {
+    const size_t points = 1 + trial % 17;
+    TrajectoryBuffer trajectory = validTrajectory(points, generator);
+    std::uniform_int_distribution<size_t> index(0, points - 1);
+    std::uniform_int_distribution<size_t> axis(0, AXES - 1);
+    for (int i = violations(generator); i > 0; i--)
+    {
+      entry(trajectory, array(generator), axis(generator), index(generator)) = value(generator);
+    }
+    ASSERT_TRUE(matchesReference(trajectory, GetParam(), limits())) << "trial " << trial;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(SplineTypes, TrajectoryValidation,
+                        ::testing::Values(TrajectoryType::Linear, TrajectoryType::Cubic, TrajectoryType::Quintic));